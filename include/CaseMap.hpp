@@ -0,0 +1,140 @@
+#ifndef CASEMAP_HPP
+#define CASEMAP_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "StringRef.hpp"
+#include "utils.hpp"
+
+// Table de hachage indexée par nom IRC, insensible à la casse (casemapping RFC 1459)
+// Les recherches se font sur une vue (StringRef): aucune allocation.
+template <typename T>
+class CaseMap {
+private:
+    struct Node {
+        std::string key;                    // Nom tel qu'enregistré (casse d'origine)
+        size_t hash;                        // Hash du nom normalisé
+        T value;
+        Node* next;
+    };
+
+    std::vector<Node*> _buckets;            // Chaînage par bucket (taille = puissance de 2)
+    size_t _size;
+
+    CaseMap(const CaseMap&);
+    CaseMap& operator=(const CaseMap&);
+
+    // FNV-1a sur les octets normalisés
+    static size_t _hash(const StringRef& key) {
+        size_t h = 2166136261u;
+        for (size_t i = 0; i < key.length; ++i) {
+            h ^= static_cast<unsigned char>(ircToLower(key[i]));
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    Node** _findSlot(const StringRef& key, size_t hash) {
+        Node** slot = &_buckets[hash & (_buckets.size() - 1)];
+        while (*slot != NULL) {
+            if ((*slot)->hash == hash && ircEqualsIgnoreCase((*slot)->key, key)) {
+                break;
+            }
+            slot = &(*slot)->next;
+        }
+        return slot;
+    }
+
+    // Doubler le nombre de buckets quand la charge dépasse 1
+    void _grow() {
+        std::vector<Node*> old;
+        old.swap(_buckets);
+        _buckets.assign(old.size() * 2, static_cast<Node*>(NULL));
+        for (size_t i = 0; i < old.size(); ++i) {
+            Node* node = old[i];
+            while (node != NULL) {
+                Node* next = node->next;
+                Node*& head = _buckets[node->hash & (_buckets.size() - 1)];
+                node->next = head;
+                head = node;
+                node = next;
+            }
+        }
+    }
+
+public:
+    CaseMap() : _buckets(16, static_cast<Node*>(NULL)), _size(0) {}
+    ~CaseMap() { clear(); }
+
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    // Mémoire d'une entrée: nœud, clé et jusqu'à deux buckets (charge entre 1/2 et 1)
+    static size_t entryCost(const StringRef& key) { return sizeof(Node) + key.length + 2 * sizeof(Node*); }
+
+    // Hash insensible à la casse (réparti aussi entre parts: ShardedCaseMap)
+    static size_t hash(const StringRef& key) { return _hash(key); }
+
+    // Valeur associée au nom, NULL si absent
+    T* find(const StringRef& key) {
+        Node* node = *_findSlot(key, _hash(key));
+        return node ? &node->value : NULL;
+    }
+
+    // Ajouter une entrée; false si le nom (à la casse près) existe déjà
+    bool insert(const std::string& key, const T& value) {
+        size_t hash = _hash(key);
+        Node** slot = _findSlot(key, hash);
+        if (*slot != NULL) {
+            return false;
+        }
+        Node* node = new Node;
+        node->key = key;
+        node->hash = hash;
+        node->value = value;
+        node->next = NULL;
+        *slot = node;
+        if (++_size > _buckets.size()) {
+            _grow();
+        }
+        return true;
+    }
+
+    // Retirer une entrée; false si absente
+    bool erase(const StringRef& key) {
+        Node** slot = _findSlot(key, _hash(key));
+        Node* node = *slot;
+        if (node == NULL) {
+            return false;
+        }
+        *slot = node->next;
+        delete node;
+        --_size;
+        return true;
+    }
+
+    // Copier toutes les valeurs (hors chemin critique: nettoyage, statistiques)
+    void values(std::vector<T>& out) const {
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            for (Node* node = _buckets[i]; node != NULL; node = node->next) {
+                out.push_back(node->value);
+            }
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < _buckets.size(); ++i) {
+            Node* node = _buckets[i];
+            while (node != NULL) {
+                Node* next = node->next;
+                delete node;
+                node = next;
+            }
+            _buckets[i] = NULL;
+        }
+        _size = 0;
+    }
+};
+
+#endif
@@ -3,23 +3,36 @@
 
 #include <string>
 #include <vector>
-#include <map>
+#include <tr1/unordered_map>
+#include <pthread.h>
+#include "Membership.hpp"
+#include "StringRef.hpp"
+#include "SharedBuffer.hpp"
+#include "ChannelHistory.hpp"
 
-// Forward declaration
+// Forward declarations
 class Client;
+class Server;
 
+// Channel partagé par les reactors de ses membres
+// Tout accès à l'état du channel (membres, modes, topic) se fait sous son verrou,
+// pris via Server::lockChannel; les messages sont envoyés après l'avoir relâché.
 class Channel {
 private:
+    pthread_mutex_t _lock;
+    bool _dead;                                 // Vidé et retiré de l'index (libéré plus tard)
     std::string _name;                          // Nom du channel (#general)
     std::string _topic;                         // Topic du channel
-    std::vector<Client*> _members;              // Liste des membres
-    std::map<Client*, bool> _operators;         // Client -> est operator ?
+    std::vector<Membership*> _members;          // Liens des membres, contigus pour le broadcast
+    std::tr1::unordered_map<Client*, Membership*> _member_index; // Client -> lien
     
     // Modes du channel
     bool _invite_only;                          // Mode +i
     bool _topic_restricted;                     // Mode +t
     std::string _key;                           // Mode +k (password)
     int _user_limit;                            // Mode +l (0 = pas de limite)
+    
+    ChannelHistory _history;                    // Derniers messages (bornés par HistoryStore)
 
 public:
     // Constructeur
@@ -29,17 +42,24 @@ public:
     // Getters
     const std::string& getName() const { return _name; }
     const std::string& getTopic() const { return _topic; }
-    const std::vector<Client*>& getMembers() const { return _members; }
+    const std::vector<Membership*>& getMembers() const { return _members; }
+    size_t getMemberCount() const { return _members.size(); }
+    ChannelHistory& getHistory() { return _history; }
+    pthread_mutex_t* getLock() { return &_lock; }
+    bool isDead() const { return _dead; }
+    void markDead() { _dead = true; }
     
     // Gestion des membres
-    void addMember(Client* client, bool is_operator = false);
-    void removeMember(Client* client);
+    Membership* addMember(Client* client, bool is_operator = false);
+    void removeMembership(Membership* membership); // O(1), libère le lien
+    Membership* findMembership(Client* client) const;
     bool isMember(Client* client) const;
     bool isOperator(Client* client) const;
+    bool isVoiced(Client* client) const;
     bool isEmpty() const { return _members.empty(); }
     
-    // Broadcast de messages
-    void broadcastMessage(const std::string& message, Client* sender = NULL);
+    // Destinataires d'une diffusion (sauf except), relevés sous le verrou
+    void collectMembers(std::vector<Client*>& out, Client* except = NULL) const;
     
     // Gestion des modes
     void setTopic(const std::string& topic) { _topic = topic; }
@@ -56,6 +76,11 @@ public:
     // Gestion des opérateurs
     void addOperator(Client* client);
     void removeOperator(Client* client);
+    
+private:
+    // Non copiable (possède les liens de ses membres)
+    Channel(const Channel&);
+    Channel& operator=(const Channel&);
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef CHANNELHISTORY_HPP
+#define CHANNELHISTORY_HPP
+
+#include <vector>
+#include <cstddef>
+#include "SharedBuffer.hpp"
+
+#define HISTORY_RING_MIN 8                  // Cases de l'anneau au premier message
+
+struct HistoryTombstone;
+
+// Message conservé dans l'historique d'un channel
+struct HistoryEntry {
+    SharedBuffer line;                      // Même bloc que celui diffusé aux membres (aucune copie)
+    long long time_ms;                      // Réception (epoch, ms), croissant dans un historique
+
+    HistoryEntry() : time_ms(0) {}
+};
+
+// Anneau des derniers messages d'un channel, borné en nombre et en octets
+// Les bornes et le budget global sont appliqués par HistoryStore, qui chaîne
+// aussi les historiques non vides du plus froid au plus chaud. Les octets comptés
+// sont ceux retenus: les lignes et toutes les cases de l'anneau, même vides.
+class ChannelHistory {
+private:
+    std::vector<HistoryEntry> _ring;        // Doublé quand il est plein, jusqu'à la borne en messages
+    size_t _first;                          // Position de l'entrée la plus ancienne
+    size_t _count;                          // Entrées présentes
+    size_t _bytes;                          // Lignes + cases de l'anneau
+
+    // Chaînage froid -> chaud, géré par HistoryStore
+    ChannelHistory* _colder;
+    ChannelHistory* _warmer;
+    bool _linked;
+    HistoryTombstone* _tombstone;           // Non NULL: historique d'un channel détruit
+
+    friend class HistoryStore;
+
+    ChannelHistory(const ChannelHistory&);
+    ChannelHistory& operator=(const ChannelHistory&);
+
+    size_t _growth(size_t capacity) const;  // Cases ajoutées par le prochain _push
+    size_t _push(const HistoryEntry& entry, size_t capacity); // Retourne les octets ajoutés
+    size_t _popOldest();                    // Retourne les octets libérés (l'anneau reste)
+    size_t _clear();
+    void _swapContents(ChannelHistory& other); // Entrées seulement (pas le chaînage)
+    size_t _search(long long time_ms, bool inclusive) const;
+
+public:
+    ChannelHistory();
+
+    size_t size() const { return _count; }
+    size_t bytes() const { return _bytes; }
+    bool empty() const { return _count == 0; }
+
+    // 0 = la plus ancienne
+    const HistoryEntry& at(size_t index) const { return _ring[(_first + index) % _ring.size()]; }
+
+    // Index de la première entrée reçue à time_ms ou après (size() si aucune)
+    size_t lowerBound(long long time_ms) const { return _search(time_ms, true); }
+    // Index de la première entrée reçue strictement après time_ms
+    size_t upperBound(long long time_ms) const { return _search(time_ms, false); }
+
+    // Octets qu'ajouterait entry: sa ligne, et les cases si l'anneau doit grandir
+    size_t pushCost(const HistoryEntry& entry, size_t capacity) const {
+        return entry.line.size() + _growth(capacity) * sizeof(HistoryEntry);
+    }
+};
+
+#endif
@@ -3,74 +3,149 @@
 
 #include <string>
 #include <vector>
+#include <pthread.h>
+#include "SendQueue.hpp"
+#include "RecvBuffer.hpp"
+#include "Membership.hpp"
+#include "TokenBucket.hpp"
+#include "TimerWheel.hpp"
+
+class Reactor;
+class Channel;
+
+// Timers d'un client, aiguillés par le reactor propriétaire
+enum ClientTimerType {
+    TIMER_KEEPALIVE,                // Délai d'enregistrement, puis PING / attente du PONG
+    TIMER_FLOOD                     // Retour du crédit de flood
+};
 
 class Client {
 private:
     // Informations de connexion
     int _fd;                        // File descriptor du socket client
     std::string _ip_address;        // Adresse IP du client
+    Reactor* _reactor;              // Shard propriétaire (seul à toucher au socket et aux buffers)
+    unsigned long _id;              // Identifiant unique (les fds sont réutilisés)
     
     // Buffer de communication
-    std::string _receive_buffer;    // Buffer pour données reçues (partielles)
-    std::string _send_buffer;       // Buffer pour données à envoyer
+    RecvBuffer _recv_buffer;        // RecvQ circulaire (données reçues, lignes partielles)
+    SendQueue _send_queue;          // File des données à envoyer
+    unsigned long _queued_bytes;    // Copie de la taille de la SendQ, lisible depuis tout thread
+    bool _write_interest;           // Surveillé en écriture (file non vide) ?
+    bool _read_interest;            // Surveillé en lecture (lecture non suspendue) ?
+    bool _flush_pending;            // Dans la liste des clients à vider en fin d'itération ?
+    bool _read_suspended;           // SendQ au-dessus du seuil bas: plus de lecture
+    bool _sendq_exceeded;           // SendQ au-dessus du plafond: éviction en cours
+    
+    // Contrôle de flood
+    TokenBucket _flood_bucket;      // Crédit de commandes
+    bool _flood_throttled;          // En attente de crédit (lignes gardées en RecvQ)
+    Timer _flood_timer;             // Armé pendant le fake lag
+    
+    // Keepalive (horloge monotone du reactor, en ms)
+    long _connected_ms;             // Connexion acceptée
+    long _last_active_ms;           // Dernières données reçues
+    long _ping_sent_ms;             // PING du serveur sans réponse (0 = aucun)
+    Timer _keepalive_timer;
     
     // Informations IRC du client
     std::string _nickname;          // Pseudonyme IRC
     std::string _username;          // Nom d'utilisateur
     std::string _realname;          // Nom réel
     std::string _hostname;          // Hostname du client
+    std::string _prefix;            // ":nick!user@host" pré-sérialisé (NICK, USER, hostname)
     
     // État d'authentification
     bool _password_ok;              // A fourni le bon password ?
     bool _registered;               // A complété NICK + USER ?
-    bool _authenticated;            // Complètement connecté ?
+    bool _authenticated;            // Complètement connecté ? (atomique: STATS l depuis un autre shard)
+    bool _disconnected;             // Socket fermé, en attente de libération (atomique)
+    bool _server_operator;          // IRC opérateur (OPER réussi)
     
-    // Channels auxquels le client appartient
-    std::vector<std::string> _channels;
+    // Liens vers les channels auxquels le client appartient
+    // Un KICK venu d'un autre shard détache aussi un lien: _membership_lock les protège
+    // (pris sous le verrou du channel concerné, jamais l'inverse).
+    pthread_mutex_t _membership_lock;
+    std::vector<Membership*> _memberships;
 
 public:
     // Constructeur/Destructeur
-    Client(int fd, const std::string& ip);
+    Client(int fd, const std::string& ip, size_t recvq_size);
     ~Client();
     
     // Getters
     int getFd() const { return _fd; }
+    Reactor* getReactor() const { return _reactor; }
+    unsigned long getId() const { return _id; }
     const std::string& getNickname() const { return _nickname; }
     const std::string& getUsername() const { return _username; }
     const std::string& getRealname() const { return _realname; }
     const std::string& getHostname() const { return _hostname; }
     const std::string& getIpAddress() const { return _ip_address; }
+    const std::string& getPrefix() const { return _prefix; }
     
     // État
     bool isPasswordOk() const { return _password_ok; }
     bool isRegistered() const { return _registered; }
-    bool isAuthenticated() const { return _authenticated; }
+    bool isAuthenticated() const { return __atomic_load_n(&_authenticated, __ATOMIC_ACQUIRE); }
+    bool isDisconnected() const { return __atomic_load_n(&_disconnected, __ATOMIC_ACQUIRE); }
+    void markDisconnected() { __atomic_store_n(&_disconnected, true, __ATOMIC_RELEASE); }
+    bool isServerOperator() const { return _server_operator; }
+    void setServerOperator(bool oper) { _server_operator = oper; }
     
     // Setters
+    void setOwner(Reactor* reactor, unsigned long id) { _reactor = reactor; _id = id; }
     void setPasswordOk(bool ok) { _password_ok = ok; }
     void setNickname(const std::string& nick);
     void setUsername(const std::string& user);
     void setRealname(const std::string& real) { _realname = real; }
-    void setHostname(const std::string& host) { _hostname = host; }
+    void setHostname(const std::string& host) { _hostname = host; _updatePrefix(); }
     
     // Gestion des buffers
-    void appendToReceiveBuffer(const std::string& data);
-    std::string extractMessage();               // Extraire un message complet
-    bool hasCompleteMessage() const;            // Y a-t-il un message complet ?
+    RecvBuffer& getRecvBuffer() { return _recv_buffer; }
+    
+    SendQueue& getSendQueue() { return _send_queue; }
+    bool hasPendingData() const { return !_send_queue.empty(); }
+    bool hasWriteInterest() const { return _write_interest; }
+    void setWriteInterest(bool enabled) { _write_interest = enabled; }
+    bool hasReadInterest() const { return _read_interest; }
+    void setReadInterest(bool enabled) { _read_interest = enabled; }
+    bool isFlushPending() const { return _flush_pending; }
+    void setFlushPending(bool pending) { _flush_pending = pending; }
     
-    void appendToSendBuffer(const std::string& data);
-    const std::string& getSendBuffer() const { return _send_buffer; }
-    void clearSendBuffer(size_t bytes_sent);    // Supprimer les bytes envoyés
-    bool hasPendingData() const { return !_send_buffer.empty(); }
+    // Limites de SendQ (gérées par le reactor propriétaire)
+    bool isReadSuspended() const { return _read_suspended; }
+    void setReadSuspended(bool suspended) { _read_suspended = suspended; }
+    bool isSendqExceeded() const { return _sendq_exceeded; }
+    void markSendqExceeded() { _sendq_exceeded = true; }
+    TokenBucket& getFloodBucket() { return _flood_bucket; }
+    bool isFloodThrottled() const { return _flood_throttled; }
+    void setFloodThrottled(bool throttled) { _flood_throttled = throttled; }
+    Timer& getFloodTimer() { return _flood_timer; }
     
-    // Gestion des channels
-    void joinChannel(const std::string& channel);
-    void leaveChannel(const std::string& channel);
-    bool isInChannel(const std::string& channel) const;
-    const std::vector<std::string>& getChannels() const { return _channels; }
+    // Keepalive et inactivité (thread du reactor uniquement)
+    void markConnected(long now_ms) { _connected_ms = now_ms; _last_active_ms = now_ms; }
+    void markActive(long now_ms) { _last_active_ms = now_ms; }
+    long getConnectedMs() const { return _connected_ms; }
+    long getLastActiveMs() const { return _last_active_ms; }
+    long getPingSentMs() const { return _ping_sent_ms; }
+    void setPingSentMs(long sent_ms) { _ping_sent_ms = sent_ms; }
+    Timer& getKeepaliveTimer() { return _keepalive_timer; }
+    unsigned long getQueuedBytes() const { return __atomic_load_n(&_queued_bytes, __ATOMIC_RELAXED); }
+    void updateQueuedBytes() { __atomic_store_n(&_queued_bytes, _send_queue.size(), __ATOMIC_RELAXED); }
+    
+    // Gestion des channels (liens maintenus par Channel)
+    void attachMembership(Membership* membership);
+    void detachMembership(Membership* membership);
+    Channel* nextChannel();                    // Un channel rejoint (NULL si aucun), pour les quitter tous
     
 private:
     void _updateRegistrationStatus();          // Vérifier si NICK+USER complets
+    void _updatePrefix();                      // Reconstruire _prefix
+    
+    // Non copiable (possède son buffer de réception)
+    Client(const Client&);
+    Client& operator=(const Client&);
 };
 
-#endif 
\ No newline at end of file
+#endif 
\ No newline at end of file
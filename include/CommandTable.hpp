@@ -0,0 +1,53 @@
+#ifndef COMMANDTABLE_HPP
+#define COMMANDTABLE_HPP
+
+#include <cstddef>
+#include "StringRef.hpp"
+
+// Forward declarations
+class Server;
+class Client;
+struct IrcMessage;
+
+typedef void (*CommandHandler)(Server* server, Client* client, const IrcMessage& msg);
+
+// Identifiant de chaque commande (index dans la table, utilisable pour des compteurs)
+enum CommandId {
+    CMD_PASS,
+    CMD_NICK,
+    CMD_USER,
+    CMD_JOIN,
+    CMD_PRIVMSG,
+    CMD_KICK,
+    CMD_INVITE,
+    CMD_TOPIC,
+    CMD_MODE,
+    CMD_PART,
+    CMD_OPER,
+    CMD_STATS,
+    CMD_PING,
+    CMD_PONG,
+    CMD_CHATHISTORY,
+    CMD_COUNT
+};
+
+// Métadonnées d'une commande, vérifiées avant l'appel du handler
+struct CommandInfo {
+    CommandId id;
+    const char* name;                       // Nom en majuscules
+    CommandHandler handler;
+    size_t min_params;                      // Sinon 461 ERR_NEEDMOREPARAMS
+    bool requires_registration;             // Sinon 451 ERR_NOTREGISTERED
+    int flood_cost;                         // Coût pour le contrôle de flood
+};
+
+// Table des commandes connues, recherche en O(1) sans allocation
+class CommandTable {
+public:
+    // Commande correspondant au nom reçu (insensible à la casse), NULL si inconnue
+    static const CommandInfo* lookup(const StringRef& command);
+
+    static const CommandInfo& get(CommandId id);
+};
+
+#endif
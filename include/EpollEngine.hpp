@@ -0,0 +1,27 @@
+#ifndef EPOLLENGINE_HPP
+#define EPOLLENGINE_HPP
+
+#include "EventEngine.hpp"
+#include <sys/epoll.h>
+
+// Moteur epoll edge-triggered: O(fds prêts) par réveil
+// En mode edge-triggered, l'appelant doit lire/accepter/écrire jusqu'à EAGAIN.
+class EpollEngine : public EventEngine {
+private:
+    int _epoll_fd;                          // Instance epoll
+    std::vector<struct epoll_event> _ready; // Tampon pour epoll_wait()
+
+    static unsigned int _toEpoll(int interest);
+
+public:
+    EpollEngine();                          // Lève une exception si epoll indisponible
+    virtual ~EpollEngine();
+
+    virtual const char* getName() const { return "epoll"; }
+    virtual bool add(int fd, int interest, void* data);
+    virtual bool modify(int fd, int interest, void* data);
+    virtual void remove(int fd);
+    virtual int wait(std::vector<IoEvent>& events, int timeout_ms);
+};
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef EVENTENGINE_HPP
+#define EVENTENGINE_HPP
+
+#include <string>
+#include <vector>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+// Intérêts / événements signalés par un moteur
+enum {
+    EVENT_READ  = 1 << 0,                   // Données à lire (ou connexion à accepter)
+    EVENT_WRITE = 1 << 1,                   // Socket prêt en écriture
+    EVENT_ERROR = 1 << 2                    // Erreur ou raccrochage
+};
+
+// Un événement prêt, renvoyé par wait()
+struct IoEvent {
+    void* data;                             // Donnée utilisateur associée au fd
+    int events;                             // Combinaison de EVENT_*
+};
+
+// Un envoi d'un lot (sendBatch): un socket et les segments de sa SendQ
+struct SendRequest {
+    int fd;
+    const struct iovec* iov;
+    int iov_count;
+    size_t length;                          // Total des segments
+    ssize_t result;                         // Octets envoyés, ou -1 (voir error)
+    int error;                              // errno de l'envoi en échec
+};
+
+// Interface commune des moteurs d'événements (poll, epoll, io_uring, ...)
+// Chaque fd est enregistré avec un pointeur utilisateur, renvoyé tel quel
+// avec ses événements: l'appelant n'a jamais à rechercher le fd.
+// Les entrées/sorties passent par le moteur (accept, receive, sendBatch): les moteurs
+// à disponibilité font les appels système classiques, un moteur à complétions
+// (io_uring) renvoie ce que le noyau a déjà accepté ou reçu pour lui.
+class EventEngine {
+public:
+    virtual ~EventEngine() {}
+
+    virtual const char* getName() const = 0;
+
+    // Enregistrer / modifier / retirer un fd (interest = EVENT_READ | EVENT_WRITE)
+    virtual bool add(int fd, int interest, void* data) = 0;
+    virtual bool modify(int fd, int interest, void* data) = 0;
+    virtual void remove(int fd) = 0;
+
+    // Attendre des événements (timeout_ms = -1: infini), remplit events
+    // Retourne le nombre d'événements, ou -1 en cas d'erreur (errno positionné)
+    virtual int wait(std::vector<IoEvent>& events, int timeout_ms) = 0;
+
+    // Listener (EVENT_READ = connexions à accepter) et socket client
+    virtual bool addListener(int fd, void* data);
+    virtual bool addConnection(int fd, int interest, void* data);
+
+    // Comme accept4(SOCK_NONBLOCK | SOCK_CLOEXEC) et readv(): -1 et EAGAIN quand rien n'est prêt
+    virtual int accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len);
+    virtual ssize_t receive(int fd, struct iovec* iov, int iov_count);
+
+    // Envoyer sur plusieurs sockets sans bloquer, remplit result/error de chaque requête
+    virtual void sendBatch(SendRequest* requests, size_t count);
+
+    // Fabrique: crée le moteur demandé, repli sur poll si indisponible
+    static EventEngine* create(const std::string& name);
+};
+
+#endif
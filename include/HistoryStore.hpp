@@ -0,0 +1,92 @@
+#ifndef HISTORYSTORE_HPP
+#define HISTORYSTORE_HPP
+
+#include <cstddef>
+#include <vector>
+#include <pthread.h>
+#include "ChannelHistory.hpp"
+#include "ServerConfig.hpp"
+#include "CaseMap.hpp"
+
+#define HISTORY_MAX_TOMBSTONES 4096         // Historiques de channels détruits gardés au plus
+
+// Historique d'un channel vidé puis détruit, rendu à sa recréation
+// Il reste dans la liste froid -> chaud: le budget l'évince comme les autres.
+struct HistoryTombstone {
+    std::string name;
+    ChannelHistory history;
+    HistoryTombstone* older;                // Ordre de destruction (le plus ancien part en premier)
+    HistoryTombstone* newer;
+
+    HistoryTombstone() : older(NULL), newer(NULL) {}
+};
+
+// Fenêtres de lecture (JOIN, CHATHISTORY)
+enum HistoryQuery {
+    HISTORY_LATEST_ALL,                     // Les plus récentes
+    HISTORY_LATEST,                         // Les plus récentes reçues après time_ms
+    HISTORY_BEFORE,                         // Les plus proches avant time_ms
+    HISTORY_AFTER                           // Les plus proches après time_ms
+};
+
+// Politique des historiques de channel: bornes par channel et budget mémoire global
+// Les historiques non vides forment une liste du plus froid (dernier message le plus
+// ancien) au plus chaud: au-delà du budget, on retire les plus vieux messages des
+// channels les plus froids, en O(1) par message retiré. L'historique d'un channel
+// détruit (tous ses membres partis) est gardé sous le même budget jusqu'à sa
+// recréation: une reconnexion générale ne perd pas le contexte. Le budget compte
+// aussi les anneaux et les pierres tombales elles-mêmes, au plus HISTORY_MAX_TOMBSTONES.
+// Le budget fait évincer depuis n'importe quel channel: tout accès à un anneau passe
+// par le verrou du store, pris en dernier (sous celui d'un channel ou d'une part de
+// l'index des channels) et tenu O(1) par message. bytes() et evictions() se lisent
+// sans verrou (métriques).
+class HistoryStore {
+private:
+    pthread_mutex_t _lock;
+    size_t _max_lines;                      // Messages par channel (0 = historique désactivé)
+    size_t _max_bytes;                      // Octets par channel
+    size_t _budget;                         // Octets pour tous les channels
+    unsigned long _bytes;                   // Octets conservés (jauge atomique)
+    unsigned long _evictions;               // Messages retirés pour tenir le budget (atomique)
+    ChannelHistory* _coldest;
+    ChannelHistory* _hottest;
+    CaseMap<HistoryTombstone*> _tombstones; // Nom du channel détruit -> historique gardé
+    HistoryTombstone* _oldest_tombstone;
+    HistoryTombstone* _newest_tombstone;
+
+    HistoryStore(const HistoryStore&);
+    HistoryStore& operator=(const HistoryStore&);
+
+    void _link(ChannelHistory& history);    // En tête chaude
+    void _unlink(ChannelHistory& history);
+    void _dropOldest(ChannelHistory& history);
+    void _enforceBudget();
+    void _release(ChannelHistory& history); // Sous _lock
+    void _move(ChannelHistory& from, ChannelHistory& to); // Contenu et place dans la liste
+    void _bury(HistoryTombstone* tombstone); // En tête récente, coût compté
+    void _unbury(HistoryTombstone* tombstone); // Retirée de l'index puis libérée
+    static size_t _tombstoneCost(const std::string& name);
+
+public:
+    explicit HistoryStore(const ServerConfig& config);
+    ~HistoryStore();
+
+    bool isEnabled() const { return _max_lines > 0; }
+    size_t getMaxLines() const { return _max_lines; }
+
+    // Conserver une ligne déjà diffusée (partage son bloc)
+    void record(ChannelHistory& history, const SharedBuffer& line);
+    // Oublier tout l'historique (arrêt du serveur)
+    void release(ChannelHistory& history);
+    // Channel détruit: garder son historique sous le budget / channel (re)créé: le reprendre
+    void retire(const std::string& name, ChannelHistory& history);
+    void restore(const StringRef& name, ChannelHistory& history);
+    // Copier au plus limit lignes de la fenêtre, de la plus ancienne à la plus récente
+    void select(const ChannelHistory& history, HistoryQuery query, long long time_ms, size_t limit,
+                std::vector<SharedBuffer>& out);
+
+    unsigned long bytes() const;
+    unsigned long evictions() const;
+};
+
+#endif
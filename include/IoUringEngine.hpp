@@ -0,0 +1,163 @@
+#ifndef IOURINGENGINE_HPP
+#define IOURINGENGINE_HPP
+
+#include "EventEngine.hpp"
+#include <deque>
+#include <linux/io_uring.h>
+
+#define URING_SQ_ENTRIES 1024               // File de soumission
+#define URING_CQ_ENTRIES 8192               // File de complétion (les multishot en produisent beaucoup)
+#define URING_BUFFER_COUNT 1024             // Buffers par groupe fourni au noyau (puissance de 2)
+#define URING_BUFFER_SIZE 4096
+#define URING_GROUP_CONNECTIONS 256         // Connexions par groupe avant d'en ajouter un
+#define URING_MAX_BUFFER_GROUPS 64
+
+// Moteur io_uring (appels système directs, sans liburing), noyau >= 6.0
+// - listener: un accept multishot, les fds acceptés attendent accept();
+// - clients: un recv multishot dans un anneau de buffers fournis au noyau,
+//   les données attendent receive() (aucun appel système de lecture); un anneau
+//   est ajouté par URING_GROUP_CONNECTIONS connexions du shard;
+// - écriture: poll POLLOUT à la demande, et envois groupés en une soumission;
+// - autres fds: poll multishot.
+// Les soumissions s'accumulent et partent avec l'attente suivante: un seul
+// io_uring_enter() par itération, quel que soit le nombre de sockets actifs.
+class IoUringEngine : public EventEngine {
+private:
+    enum FdKind {
+        FD_GENERIC,                         // Poll multishot (eventfd, ...)
+        FD_LISTENER,                        // Accept multishot
+        FD_CONNECTION                       // Recv multishot + POLLOUT à la demande
+    };
+
+    // Opération en vol, codée dans les bits bas du user_data (FdState aligné sur 8)
+    enum Operation {
+        OP_NONE,                            // Annulations: complétion ignorée
+        OP_MULTISHOT,                       // Accept, recv ou poll multishot du fd
+        OP_POLLOUT,                         // Attente d'écriture (one-shot)
+        OP_SEND                             // Envoi d'un lot (index et génération dans les bits hauts)
+    };
+
+    // Données reçues pas encore lues
+    struct Chunk {
+        unsigned short buffer_id;
+        unsigned length;
+        unsigned offset;
+    };
+
+    struct FdState;
+
+    // Anneau de buffers fournis, partagé par les connexions qui lui sont attribuées
+    struct BufferGroup {
+        unsigned short id;                  // bgid des recv
+        struct io_uring_buf_ring* ring;
+        size_t ring_size;
+        char* buffers;
+        unsigned short tail;
+        size_t connections;                 // Connexions attribuées
+        std::vector<FdState*> starved;      // Recv à relancer dès qu'un buffer revient
+    };
+
+    // État d'un fd; après remove(), détaché jusqu'à la dernière complétion
+    struct FdState {
+        int fd;
+        FdKind kind;
+        int interest;
+        void* data;
+        bool closed;                        // Retiré par l'appelant
+        int inflight;                       // Opérations soumises sans complétion finale
+        bool multishot;                     // Accept / recv / poll multishot armé
+        bool cancelling;                    // Annulation du multishot demandée
+        bool pollout;                       // POLLOUT armé
+        bool starved;                       // Recv sans buffer libre / accept sans fd (EMFILE...)
+        int end_error;                      // Recv terminé: -1 = non, 0 = EOF, sinon errno
+        int pending;                        // Événements à rendre au prochain wait()
+        bool queued;                        // Dans _rearm ?
+        BufferGroup* group;                 // Recv: anneau de ses buffers (NULL hors connexions)
+        std::deque<Chunk> chunks;           // Recv: données en attente de receive()
+        std::deque<int> accepted;           // Accept: connexions en attente d'accept()
+    };
+
+    int _ring_fd;
+    unsigned _features;
+
+    // Files partagées avec le noyau
+    void* _sq_ring;
+    size_t _sq_ring_size;
+    void* _cq_ring;                         // = _sq_ring si IORING_FEAT_SINGLE_MMAP
+    size_t _cq_ring_size;
+    struct io_uring_sqe* _sqes;
+    size_t _sqes_size;
+    unsigned* _sq_head;
+    unsigned* _sq_tail;
+    unsigned* _sq_array;
+    unsigned _sq_mask;
+    unsigned _sq_entries;
+    unsigned _sq_local_tail;                // Entrées préparées, publiées par _publish()
+    unsigned* _cq_head;
+    unsigned* _cq_tail;
+    unsigned _cq_mask;
+    struct io_uring_cqe* _cqes;
+
+    // Anneaux de buffers de réception (jamais retirés avant _release())
+    std::vector<BufferGroup*> _groups;
+
+    std::vector<FdState*> _fds;             // fd -> état actif (NULL = absent)
+    std::vector<FdState*> _detached;        // Retirés, opérations encore en vol
+    std::vector<FdState*> _rearm;           // À (ré)armer avant la prochaine soumission
+    std::vector<FdState*> _ready;           // Événements en attente pour wait()
+    std::vector<FdState*> _starved_listeners; // Accept à relancer dès qu'un fd se libère
+
+    // Lot d'envois en cours
+    SendRequest* _batch;
+    std::vector<struct msghdr> _batch_msgs;
+    size_t _batch_remaining;
+    unsigned _batch_generation;             // Dans les bits hauts du user_data: complétions périmées ignorées
+
+    IoUringEngine(const IoUringEngine&);
+    IoUringEngine& operator=(const IoUringEngine&);
+
+    void _setupRing();
+    BufferGroup* _addBufferGroup();
+    BufferGroup* _pickBufferGroup();        // Moins chargé, ou nouveau si tous sont pleins
+    void _freeBufferGroup(BufferGroup* group);
+    void _checkSupport();
+    void _release();
+
+    struct io_uring_sqe* _getSqe();
+    void _publish();
+    int _enter(unsigned to_submit, unsigned min_complete, unsigned flags, int timeout_ms);
+    void _reapCompletions();
+    void _complete(const struct io_uring_cqe& cqe);
+    void _completeMultishot(FdState* state, const struct io_uring_cqe& cqe);
+    void _recycleBuffer(BufferGroup* group, unsigned short buffer_id);
+    void _abortBatch(int error);
+
+    FdState* _register(int fd, FdKind kind, int interest, void* data);
+    void _queueRearm(FdState* state);
+    void _queueReady(FdState* state, int events);
+    void _armPending();
+    void _arm(FdState* state);
+    void _cancel(FdState* state, Operation operation);
+    void _finish(FdState* state);           // Une opération de moins en vol
+    void _dropData(FdState* state);
+
+    static unsigned long long _userData(FdState* state, Operation operation);
+
+public:
+    IoUringEngine();                        // Lève une exception si io_uring indisponible
+    virtual ~IoUringEngine();
+
+    virtual const char* getName() const { return "io_uring"; }
+    virtual bool add(int fd, int interest, void* data);
+    virtual bool modify(int fd, int interest, void* data);
+    virtual void remove(int fd);
+    virtual int wait(std::vector<IoEvent>& events, int timeout_ms);
+
+    virtual bool addListener(int fd, void* data);
+    virtual bool addConnection(int fd, int interest, void* data);
+    virtual int accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len);
+    virtual ssize_t receive(int fd, struct iovec* iov, int iov_count);
+    virtual void sendBatch(SendRequest* requests, size_t count);
+};
+
+#endif
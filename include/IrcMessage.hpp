@@ -0,0 +1,32 @@
+#ifndef IRCMESSAGE_HPP
+#define IRCMESSAGE_HPP
+
+#include <cstddef>
+#include "StringRef.hpp"
+
+// Nombre maximal de paramètres d'un message (RFC 1459: 14 "middle" + 1 "trailing")
+#define IRC_MAX_PARAMS 15
+
+// Message IRC découpé selon la RFC 1459:
+//   [':' prefix SPACE] command {SPACE middle} [SPACE ':' trailing]
+// Toutes les parties sont des vues sur la ligne reçue: aucune allocation.
+struct IrcMessage {
+    StringRef prefix;                       // Sans le ':' initial (vide si absent)
+    StringRef command;                      // Tel que reçu (casse non normalisée)
+    StringRef params[IRC_MAX_PARAMS];       // Paramètres, le "trailing" en dernier
+    size_t param_count;
+    bool has_trailing;                      // Le dernier paramètre était-il introduit par ':' ?
+
+    IrcMessage() : param_count(0), has_trailing(false) {}
+
+    // Paramètre i, ou vue vide s'il est absent
+    const StringRef& param(size_t i) const {
+        static const StringRef empty_ref;
+        return i < param_count ? params[i] : empty_ref;
+    }
+
+    // Découper une ligne (sans CRLF); false si aucune commande
+    static bool parse(const StringRef& line, IrcMessage& out);
+};
+
+#endif
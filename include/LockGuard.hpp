@@ -0,0 +1,39 @@
+#ifndef LOCKGUARD_HPP
+#define LOCKGUARD_HPP
+
+#include <pthread.h>
+#include <cstddef>
+
+// Verrou déjà pris par l'appelant (Server::lockChannel) ou à prendre
+enum LockMode {
+    LOCK_ACQUIRE,
+    LOCK_ADOPT
+};
+
+// Verrou tenu jusqu'à la fin de la portée, ou relâché plus tôt par unlock()
+// (les diffusions se font toujours après avoir relâché le verrou du channel)
+// NULL: rien à verrouiller (second verrou identique au premier, par exemple)
+class LockGuard {
+private:
+    pthread_mutex_t* _lock;
+
+    LockGuard(const LockGuard&);
+    LockGuard& operator=(const LockGuard&);
+
+public:
+    explicit LockGuard(pthread_mutex_t* lock, LockMode mode = LOCK_ACQUIRE) : _lock(lock) {
+        if (_lock != NULL && mode == LOCK_ACQUIRE) {
+            pthread_mutex_lock(_lock);
+        }
+    }
+    ~LockGuard() { unlock(); }
+
+    void unlock() {
+        if (_lock != NULL) {
+            pthread_mutex_unlock(_lock);
+            _lock = NULL;
+        }
+    }
+};
+
+#endif
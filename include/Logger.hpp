@@ -0,0 +1,101 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <cstddef>
+#include "StringRef.hpp"
+
+// Niveaux de journalisation
+enum LogLevel {
+    LOG_LEVEL_DEBUG = 0,                    // Détail par commande/message (hot path)
+    LOG_LEVEL_INFO = 1,                     // Connexions, channels, cycle de vie
+    LOG_LEVEL_WARN = 2,                     // Situations anormales mais récupérables
+    LOG_LEVEL_ERROR = 3,                    // Erreurs système
+    LOG_LEVEL_OFF = 4
+};
+
+// Catégories (masque de bits)
+enum LogCategory {
+    LOG_SERVER = 1 << 0,                    // Démarrage, arrêt, reactors
+    LOG_NET = 1 << 1,                       // Sockets, accept, envois
+    LOG_CMD = 1 << 2,                       // Traitement des commandes
+    LOG_CHAN = 1 << 3,                      // Channels et membres
+    LOG_CLIENT = 1 << 4,                    // État des clients
+    LOG_ALL = 0xff
+};
+
+// Niveau minimal compilé: les appels en dessous disparaissent du binaire
+// (make re LOG_MIN_LEVEL=0 pour activer le debug)
+#ifndef LOG_MIN_LEVEL
+# define LOG_MIN_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_LINE_MAX 256                    // Taille maximale d'une ligne (tronquée au-delà)
+
+// Journal asynchrone: les threads déposent des lignes formatées dans un anneau
+// sans verrou, un thread d'écriture les vide par lots sur stdout/stderr.
+// Hors de start()/stop(), les lignes sont écrites directement.
+class Logger {
+private:
+    static int s_level;                     // Niveau minimal à l'exécution
+    static unsigned s_categories;           // Catégories actives
+
+public:
+    static void start(int level, unsigned categories);
+    static void stop();                     // Vider l'anneau et arrêter le thread
+
+    static bool isEnabled(int level, unsigned category) {
+        return level >= s_level && (s_categories & category) != 0;
+    }
+
+    // Déposer une ligne formatée (thread-safe, ne bloque jamais)
+    static void submit(int level, const char* text, size_t length);
+
+    // Conversions pour les options --log-level / --log-categories
+    static bool parseLevel(const std::string& name, int& level);
+    static bool parseCategories(const std::string& list, unsigned& categories);
+};
+
+// Ligne en cours de formatage dans un buffer fixe, soumise à la destruction
+class LogLine {
+private:
+    char _buffer[LOG_LINE_MAX];
+    size_t _length;
+    int _level;
+
+    void _append(const char* data, size_t length);
+    void _appendUnsigned(unsigned long value, bool negative);
+
+    LogLine(const LogLine&);
+    LogLine& operator=(const LogLine&);
+
+public:
+    LogLine(int level, unsigned category);
+    ~LogLine();
+
+    LogLine& operator<<(const char* text);
+    LogLine& operator<<(const std::string& text) { _append(text.data(), text.length()); return *this; }
+    LogLine& operator<<(const StringRef& text) { _append(text.data, text.length); return *this; }
+    LogLine& operator<<(char c) { _append(&c, 1); return *this; }
+    LogLine& operator<<(int value);
+    LogLine& operator<<(long value);
+    LogLine& operator<<(unsigned value) { _appendUnsigned(value, false); return *this; }
+    LogLine& operator<<(unsigned long value) { _appendUnsigned(value, false); return *this; }
+};
+
+// Le test de niveau est une constante: sous LOG_MIN_LEVEL, le compilateur
+// supprime l'appel et le formatage des arguments.
+#define LOG_AT(level, category, expr) \
+    do { \
+        if ((level) >= LOG_MIN_LEVEL && Logger::isEnabled((level), (category))) { \
+            LogLine log_line_((level), (category)); \
+            log_line_ << expr; \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(category, expr) LOG_AT(LOG_LEVEL_DEBUG, category, expr)
+#define LOG_INFO(category, expr) LOG_AT(LOG_LEVEL_INFO, category, expr)
+#define LOG_WARN(category, expr) LOG_AT(LOG_LEVEL_WARN, category, expr)
+#define LOG_ERROR(category, expr) LOG_AT(LOG_LEVEL_ERROR, category, expr)
+
+#endif
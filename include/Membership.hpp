@@ -0,0 +1,27 @@
+#ifndef MEMBERSHIP_HPP
+#define MEMBERSHIP_HPP
+
+#include <cstddef>
+
+// Forward declarations
+class Client;
+class Channel;
+
+// Bits de mode d'un membre, stockés avec lui
+enum {
+    MEMBER_OPERATOR = 1 << 0,                   // Statut +o
+    MEMBER_VOICE    = 1 << 1                    // Statut +v
+};
+
+// Lien unique client <-> channel, référencé des deux côtés
+// Chaque côté mémorise la position du lien dans l'autre tableau,
+// ce qui permet de le détacher en O(1) sans recherche par nom.
+struct Membership {
+    Client* client;
+    Channel* channel;
+    unsigned int modes;                         // Combinaison de MEMBER_*
+    size_t channel_slot;                        // Index dans Channel::_members
+    size_t client_slot;                         // Index dans Client::_memberships
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include "CommandTable.hpp"
+
+#define METRICS_BUCKETS 40                  // Histogrammes en puissances de 2 (jusqu'à 2^39)
+#define METRICS_UNKNOWN_COMMAND CMD_COUNT   // Slot des commandes inconnues
+#define METRICS_NUMERIC_MIN 400             // Numériques d'erreur suivies: 400..599
+#define METRICS_NUMERIC_COUNT 200
+
+// Compteur à écrivain unique (le thread du reactor propriétaire), lisible depuis
+// n'importe quel thread: un simple load/store, sans instruction verrouillée.
+inline void metricAdd(unsigned long& counter, unsigned long value) {
+    __atomic_store_n(&counter, __atomic_load_n(&counter, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+inline void metricSet(unsigned long& gauge, unsigned long value) {
+    __atomic_store_n(&gauge, value, __ATOMIC_RELAXED);
+}
+
+inline unsigned long metricRead(const unsigned long& counter) {
+    return __atomic_load_n(&counter, __ATOMIC_RELAXED);
+}
+
+// Histogramme logarithmique: le bucket i compte les valeurs de [2^(i-1), 2^i)
+struct Histogram {
+    unsigned long buckets[METRICS_BUCKETS];
+    unsigned long count;
+    unsigned long sum;
+
+    Histogram();
+    void record(unsigned long value);
+    void accumulate(const Histogram& other); // Lecture d'un histogramme d'un autre thread
+    unsigned long percentile(double fraction) const; // Borne haute du bucket atteint
+    static unsigned long upperBound(size_t bucket) { return (1UL << bucket) - 1; }
+};
+
+// Compteurs d'un reactor (ou leur somme pour l'affichage)
+struct Metrics {
+    unsigned long commands[CMD_COUNT + 1];  // Par CommandId, + commandes inconnues
+    Histogram command_ns[CMD_COUNT + 1];    // Durée des handlers (ns)
+    unsigned long numerics[METRICS_NUMERIC_COUNT]; // Réponses d'erreur envoyées, par numérique
+    unsigned long bytes_in;
+    unsigned long bytes_out;
+    unsigned long accepted;                 // Connexions acceptées
+    unsigned long accept_batches_capped;    // Lots d'accept interrompus par accept_batch
+    unsigned long accept_queue_full;        // File d'accept trouvée pleine (débordement)
+    Histogram accept_queue;                 // Longueur de la file d'accept, échantillonnée chaque seconde
+    unsigned long clients;                  // Jauge: clients connectés
+    Histogram sendq_bytes;                  // Profondeur de la SendQ à chaque vidage
+    unsigned long read_suspensions;         // Lectures suspendues (SendQ au-dessus du seuil bas)
+    unsigned long sendq_evictions;          // Déconnexions "Max SendQ exceeded"
+    unsigned long flood_throttles;          // Clients mis en attente par le contrôle de flood
+    unsigned long pings_sent;               // PING envoyés aux clients inactifs
+    unsigned long ping_timeouts;            // Déconnexions "Ping timeout"
+    unsigned long registration_timeouts;    // Déconnexions "Registration timeout"
+
+    Metrics();
+    void accumulate(const Metrics& other);
+};
+
+// Vue agrégée de tout le serveur
+struct MetricsSnapshot {
+    Metrics totals;
+    unsigned long listen_overflows;         // TcpExt ListenOverflows du noyau (tout le système)
+    unsigned long channels;
+    unsigned long history_bytes;            // Octets conservés dans les historiques
+    unsigned long history_evictions;        // Messages retirés pour tenir le budget
+    long uptime_s;
+    size_t reactors;
+
+    MetricsSnapshot() : listen_overflows(0), channels(0), history_bytes(0), history_evictions(0), 
+                        uptime_s(0), reactors(0) {}
+
+    // Exposition texte au format Prometheus
+    void renderPrometheus(std::string& out) const;
+};
+
+// Compteur ListenOverflows de /proc/net/netstat (0 si indisponible)
+unsigned long readListenOverflows();
+
+#endif
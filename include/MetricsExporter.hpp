@@ -0,0 +1,33 @@
+#ifndef METRICSEXPORTER_HPP
+#define METRICSEXPORTER_HPP
+
+#include <pthread.h>
+
+// Forward declarations
+class Server;
+
+// Listener HTTP local (127.0.0.1) exposant les métriques au format texte Prometheus
+// Tourne dans son propre thread: un scrape lent ne bloque jamais un reactor.
+class MetricsExporter {
+private:
+    Server* _server;
+    int _listen_fd;
+    pthread_t _thread;
+    bool _thread_started;
+
+    MetricsExporter(const MetricsExporter&);
+    MetricsExporter& operator=(const MetricsExporter&);
+
+    void _serve();                          // Boucle d'acceptation (jusqu'à l'arrêt du serveur)
+    void _handleConnection(int fd);         // Lire la requête, répondre, fermer
+    static void* _threadMain(void* arg);
+
+public:
+    MetricsExporter(Server* server, int port);
+    ~MetricsExporter();
+
+    void startThread();
+    void join();
+};
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <cstddef>
+
+// Maillon intrusif d'une MpscQueue
+struct MpscNode {
+    MpscNode* next;
+    MpscNode() : next(NULL) {}
+    virtual ~MpscNode() {}
+};
+
+// File sans verrou multi-producteurs / mono-consommateur (algorithme de Vyukov)
+// push() est sûr depuis n'importe quel thread; pop() uniquement depuis le consommateur.
+class MpscQueue {
+private:
+    MpscNode* _head;                        // Dernier maillon poussé (producteurs)
+    MpscNode* _tail;                        // Prochain maillon à lire (consommateur)
+    MpscNode _stub;                         // Maillon sentinelle
+
+    MpscQueue(const MpscQueue&);
+    MpscQueue& operator=(const MpscQueue&);
+
+public:
+    MpscQueue() : _head(&_stub), _tail(&_stub) {}
+
+    void push(MpscNode* node) {
+        __atomic_store_n(&node->next, static_cast<MpscNode*>(NULL), __ATOMIC_RELAXED);
+        MpscNode* prev = __atomic_exchange_n(&_head, node, __ATOMIC_ACQ_REL);
+        __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+    }
+
+    // Retirer le plus ancien maillon; NULL si vide (ou push concurrent pas encore visible)
+    MpscNode* pop() {
+        MpscNode* tail = _tail;
+        MpscNode* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (tail == &_stub) {
+            if (next == NULL) {
+                return NULL;
+            }
+            _tail = next;
+            tail = next;
+            next = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+        }
+        if (next != NULL) {
+            _tail = next;
+            return tail;
+        }
+        if (tail != __atomic_load_n(&_head, __ATOMIC_ACQUIRE)) {
+            return NULL; // Un producteur est entre exchange et store: réessayer plus tard
+        }
+        push(&_stub);
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+        if (next != NULL) {
+            _tail = next;
+            return tail;
+        }
+        return NULL;
+    }
+
+    // Vrai si aucun maillon n'est en attente (côté consommateur)
+    bool empty() const {
+        return _tail == &_stub && __atomic_load_n(&_stub.next, __ATOMIC_ACQUIRE) == NULL
+            && __atomic_load_n(&_head, __ATOMIC_ACQUIRE) == &_stub;
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef NUMERICREPLY_HPP
+#define NUMERICREPLY_HPP
+
+#include <cstddef>
+#include "StringRef.hpp"
+
+#define REPLY_MAX_LENGTH 512                // Ligne IRC complète, CRLF compris
+
+// Réponses numériques envoyées par le serveur (index dans la table des modèles)
+enum NumericId {
+    RPL_WELCOME,
+    RPL_YOURHOST,
+    RPL_CREATED,
+    RPL_MYINFO,
+    RPL_ISUPPORT,
+    RPL_ENDOFSTATS,
+    RPL_STATSUPTIME,
+    RPL_CHANNELMODEIS,
+    RPL_NOTOPIC,
+    RPL_TOPIC,
+    RPL_INVITING,
+    RPL_YOUREOPER,
+    ERR_NOSUCHNICK,
+    ERR_NOSUCHCHANNEL,
+    ERR_CHANNELLIMIT,                       // 403 quand max-channels est atteint
+    ERR_CANNOTSENDTOCHAN,
+    ERR_INPUTTOOLONG,
+    ERR_UNKNOWNCOMMAND,
+    ERR_NONICKNAMEGIVEN,
+    ERR_NICKNAMEINUSE,
+    ERR_USERNOTINCHANNEL,
+    ERR_NOTONCHANNEL,
+    ERR_USERONCHANNEL,
+    ERR_NOTREGISTERED,
+    ERR_NEEDMOREPARAMS,
+    ERR_ALREADYREGISTRED,
+    ERR_PASSWDMISMATCH,
+    ERR_CHANNELISFULL,
+    ERR_UNKNOWNMODE,
+    ERR_INVITEONLYCHAN,
+    ERR_BADCHANNELKEY,
+    ERR_NOPRIVILEGES,
+    ERR_CHANOPRIVSNEEDED,
+    ERR_NOOPERHOST,
+    NUMERIC_COUNT
+};
+
+// Modèle d'une réponse: "<code> <cible> " puis format, où chaque '%' prend l'argument suivant
+struct NumericInfo {
+    NumericId id;
+    const char* code;                       // Trois chiffres
+    const char* format;
+};
+
+// Réponse numérique formatée dans un tableau de taille fixe (aucune allocation)
+// Les arguments trop longs sont tronqués: la ligne garde toujours son CRLF.
+class NumericReply {
+private:
+    char _data[REPLY_MAX_LENGTH];
+    size_t _length;
+
+    NumericReply(const NumericReply&);
+    NumericReply& operator=(const NumericReply&);
+
+    void _append(const char* data, size_t length);
+
+public:
+    NumericReply(NumericId id, const StringRef& target, const StringRef& arg1 = StringRef(),
+                 const StringRef& arg2 = StringRef(), const StringRef& arg3 = StringRef());
+
+    const char* data() const { return _data; }
+    size_t length() const { return _length; }
+    StringRef ref() const { return StringRef(_data, _length); }
+
+    static const NumericInfo& get(NumericId id);
+};
+
+#endif
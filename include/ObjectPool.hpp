@@ -0,0 +1,88 @@
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <vector>
+#include <cstdlib>
+#include <cstddef>
+
+#define POOL_SLAB_OBJECTS 64                // Objets alloués par slab
+
+// Allocateur à slabs pour des objets de même type, borné par une capacité maximale
+// Les slabs sont alloués à la demande puis jamais rendus: les objets libérés
+// retournent dans une liste libre et les vagues de reconnexion ne touchent plus à malloc.
+// Non thread-safe: chaque pool appartient à un seul thread (ou est protégé par son verrou).
+template <typename T>
+class ObjectPool {
+private:
+    // Case libre: le début de la case sert de maillon
+    union Slot {
+        Slot* next;
+        char storage[sizeof(T)];
+        long double align_ld;               // Alignement maximal (C++98)
+        void* align_ptr;
+    };
+
+    std::vector<Slot*> _slabs;              // Blocs de POOL_SLAB_OBJECTS cases
+    Slot* _free;                            // Liste des cases libres
+    size_t _capacity;                       // Nombre maximal d'objets vivants
+    size_t _in_use;
+
+    ObjectPool(const ObjectPool&);
+    ObjectPool& operator=(const ObjectPool&);
+
+    // Ajouter un slab à la liste libre (sans dépasser la capacité)
+    bool _grow() {
+        size_t count = _capacity - _slabs.size() * POOL_SLAB_OBJECTS;
+        if (count > POOL_SLAB_OBJECTS) {
+            count = POOL_SLAB_OBJECTS;
+        }
+        Slot* slab = static_cast<Slot*>(std::malloc(count * sizeof(Slot)));
+        if (slab == NULL) {
+            return false;
+        }
+        _slabs.push_back(slab);
+        for (size_t i = count; i > 0; --i) {
+            slab[i - 1].next = _free;
+            _free = &slab[i - 1];
+        }
+        return true;
+    }
+
+public:
+    explicit ObjectPool(size_t capacity) : _free(NULL), _capacity(capacity), _in_use(0) {}
+
+    // Les objets encore vivants doivent avoir été détruits avant le pool
+    ~ObjectPool() {
+        for (size_t i = 0; i < _slabs.size(); ++i) {
+            std::free(_slabs[i]);
+        }
+    }
+
+    // Case non construite (placement new), NULL si le pool est plein
+    void* allocate() {
+        if (_free == NULL && (_in_use >= _capacity || !_grow())) {
+            return NULL;
+        }
+        Slot* slot = _free;
+        _free = slot->next;
+        ++_in_use;
+        return slot;
+    }
+
+    // Détruire un objet et rendre sa case
+    void destroy(T* object) {
+        if (object == NULL) {
+            return;
+        }
+        object->~T();
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next = _free;
+        _free = slot;
+        --_in_use;
+    }
+
+    size_t inUse() const { return _in_use; }
+    size_t capacity() const { return _capacity; }
+};
+
+#endif
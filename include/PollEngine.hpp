@@ -0,0 +1,25 @@
+#ifndef POLLENGINE_HPP
+#define POLLENGINE_HPP
+
+#include "EventEngine.hpp"
+#include <poll.h>
+
+// Moteur de repli basé sur poll(): O(fds surveillés) par réveil
+class PollEngine : public EventEngine {
+private:
+    std::vector<struct pollfd> _poll_fds;   // Array pour poll()
+    std::vector<void*> _data;               // Donnée utilisateur, même index que _poll_fds
+    std::vector<int> _index_of;             // fd -> index dans _poll_fds (-1 = absent)
+
+public:
+    PollEngine();
+    virtual ~PollEngine();
+
+    virtual const char* getName() const { return "poll"; }
+    virtual bool add(int fd, int interest, void* data);
+    virtual bool modify(int fd, int interest, void* data);
+    virtual void remove(int fd);
+    virtual int wait(std::vector<IoEvent>& events, int timeout_ms);
+};
+
+#endif
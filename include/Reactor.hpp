@@ -0,0 +1,178 @@
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <pthread.h>
+
+#include "EventEngine.hpp"
+#include "SharedBuffer.hpp"
+#include "MpscQueue.hpp"
+#include "Metrics.hpp"
+#include "ObjectPool.hpp"
+#include "TickArena.hpp"
+#include "TimerWheel.hpp"
+
+#include "Client.hpp"
+
+#define ACCEPT_SAMPLE_INTERVAL_MS 1000      // Période de mesure de la file d'accept (TCP_INFO)
+#define RECLAIM_POLL_MS 10                  // Attente maximale tant que des objets retirés restent à libérer
+
+// Forward declarations
+class Server;
+class Channel;
+
+// Référence vers un client d'un autre shard, revalidée par son propriétaire
+// (le Client a pu être libéré entre l'envoi et la livraison)
+struct ClientRef {
+    Client* client;
+    int fd;
+    unsigned long id;
+};
+
+// Lot de messages destinés aux clients d'un même shard
+struct Delivery : public MpscNode {
+    std::vector<ClientRef> targets;
+    std::vector<SharedBuffer> messages;     // Même index que targets
+};
+
+// Clients et channels retirés de l'état partagé pendant une itération
+// D'autres reactors ont pu les trouver juste avant (index, liste de membres): ils ne
+// sont libérés qu'une fois que chacun a terminé l'itération en cours au moment du retrait.
+struct RetiredBatch {
+    std::vector<unsigned long> epochs;      // Époque de chaque reactor au retrait
+    std::vector<Client*> clients;
+    std::vector<Channel*> channels;
+};
+
+// Boucle d'événements d'un shard: un thread, un listener SO_REUSEPORT, ses clients
+// Seul le thread du reactor touche aux sockets, buffers et files d'envoi de ses clients;
+// les autres shards lui livrent des messages via sa boîte de réception sans verrou.
+class Reactor {
+private:
+    Server* _server;
+    int _index;                             // Numéro du shard
+    
+    // Socket et réseau
+    int _listen_fd;                         // Listener propre au shard (SO_REUSEPORT)
+    int _wake_fd;                           // eventfd pour réveiller la boucle
+    bool _accept_pending;                   // Plafond d'accept atteint: reprendre à l'itération suivante
+    
+    // Boucle d'événements
+    EventEngine* _engine;                   // Moteur d'événements (io_uring/epoll/poll)
+    std::vector<IoEvent> _events;           // Événements prêts de l'itération courante
+    pthread_t _thread;
+    bool _thread_started;
+    
+    // Gestion des clients du shard
+    ObjectPool<Client> _client_pool;        // Cases des Client (max-clients vérifié par Server)
+    std::map<int, Client*> _clients;        // Map fd -> Client*
+    std::vector<Client*> _closed_clients;   // Clients déconnectés pendant l'itération
+    std::vector<Channel*> _closed_channels; // Channels vidés pendant l'itération
+    std::deque<RetiredBatch*> _retired;     // En attente de l'itération des autres reactors
+    unsigned long _epoch;                   // Itérations (atomique); impaire: bloqué dans wait(), sans référence
+    
+    // Sorties regroupées (un envoi par client et par itération)
+    std::vector<Client*> _dirty_clients;    // Clients ayant des données en file
+    long _dirty_since_ms;                   // Horloge monotone du premier message en file
+    std::vector<Client*> _send_clients;     // Clients du lot d'envois en cours
+    std::vector<SendRequest> _send_requests;
+    std::vector<struct iovec> _send_iov;    // SENDQUEUE_MAX_IOV segments par client du lot
+    
+    // Limites de SendQ
+    size_t _sendq_hard;                     // Plafond: éviction du client
+    size_t _sendq_soft;                     // Seuil bas: lecture suspendue jusqu'à la moitié
+    std::vector<Client*> _slow_clients;     // Plafond dépassé, à déconnecter hors des handlers
+    std::vector<Client*> _resume_clients;   // Lecture à reprendre (lignes déjà en RecvQ)
+    
+    // Timers (keepalive, fake lag)
+    long _now_ms;                           // Horloge monotone, lue une fois par itération
+    TimerWheel _timers;
+    std::vector<Timer*> _expired_timers;    // Timers échus de l'itération
+    Timer _accept_sample_timer;             // Échantillonnage périodique de la file d'accept
+    
+    // Livraisons entre shards
+    MpscQueue _inbox;                       // Lots reçus des autres shards
+    int _wake_pending;                      // Réveil déjà demandé ? (atomique)
+    std::vector<Delivery*> _outgoing;       // Lots en préparation, par shard destinataire
+    
+    // Temporaires de l'itération (réponses, messages relayés, destinataires d'une diffusion)
+    TickArena _arena;
+    std::vector<Client*> _recipients;
+    
+    // Instrumentation (écrite par ce thread uniquement)
+    Metrics _metrics;
+
+    Reactor(const Reactor&);
+    Reactor& operator=(const Reactor&);
+
+public:
+    Reactor(Server* server, int index);
+    ~Reactor();
+    
+    void open();                            // Créer le listener, l'eventfd et le moteur
+    void run();                             // Boucle d'événements (thread courant)
+    void startThread();                     // Lancer run() dans un nouveau thread
+    void join();
+    void wake();                            // Réveiller la boucle (thread-safe)
+    
+    int getIndex() const { return _index; }
+    Metrics& getMetrics() { return _metrics; }
+    TickArena& getArena() { return _arena; }
+    std::vector<Client*>& getRecipients() { _recipients.clear(); return _recipients; } // Vidé, sans réallocation
+    unsigned long getEpoch() const { return __atomic_load_n(&_epoch, __ATOMIC_SEQ_CST); }
+    const char* getEngineName() const { return _engine ? _engine->getName() : "none"; }
+    
+    // Reactor du thread appelant (NULL hors d'une boucle)
+    static Reactor* current();
+    static void setCurrent(Reactor* reactor); // Fait par run(); utilisé aussi par les outils de mesure
+    
+    // Sorties: client de ce shard / client d'un autre shard
+    void enqueue(Client* client, const SharedBuffer& message);
+    void enqueue(Client* client, const char* data, size_t length);
+    void route(Client* client, const SharedBuffer& message);
+    
+    void disconnectClient(Client* client, const std::string& reason);
+    void retire(Channel* channel);          // Channel retiré de l'index, libéré après la période de grâce
+
+private:
+    // Méthodes d'initialisation
+    void _setupSocket();                    // Créer et configurer le socket
+    void _bindAndListen();                  // Bind + listen
+    
+    // Gestion des connexions
+    void _acceptNewClients();               // Accepter les connexions en attente (par lots)
+    void _sampleAcceptQueue();              // Profondeur de la file d'accept (TCP_INFO), chaque seconde
+    void _rejectClient(int client_fd);      // Pool plein: refuser la connexion
+    void _handleClientData(Client* client); // Traiter données d'un client
+    void _processLines(Client* client);     // Exécuter les lignes complètes de la RecvQ
+    void _flushClient(Client* client);      // Vider la file d'envoi d'un client
+    void _queued(Client* client);           // Après un ajout en SendQ: limites, client à vider
+    void _flushDirtyClients();              // Vider les files remplies pendant l'itération
+    bool _completeSend(Client* client, const SendRequest& request); // Vrai: renvoyer au tour suivant
+    void _afterFlush(Client* client);       // Reprise de la lecture et intérêts selon la file restante
+    int _computeWaitTimeout() const;        // Timeout de wait() selon la fenêtre de batching
+    void _updateInterest(Client* client);   // Écriture ssi file non vide, lecture sauf si suspendue
+    void _evictSlowClients();               // Déconnecter les clients au-delà du plafond
+    void _resumeClients();                  // Reprendre la lecture des clients dont la file s'est vidée
+    void _throttleClient(Client* client);   // Plus de crédit: différer les lignes restantes
+    void _runTimers();                      // Aiguiller les timers échus
+    void _startKeepalive(Client* client);   // Premier armement, à l'acceptation
+    void _checkKeepalive(Client* client);   // Délai d'enregistrement, PING, délai du PONG
+    void _releaseThrottledClient(Client* client); // Crédit revenu: reprendre, sinon réarmer
+    void _closeLink(Client* client, const std::string& reason); // ERROR puis déconnexion
+    void _retireClosed();                   // Clients et channels retirés pendant l'itération
+    void _reclaim(bool force);              // Libérer les lots que plus aucun reactor ne voit
+    bool _graceElapsed(const RetiredBatch& batch) const;
+    void _setQuiescent(bool quiescent);     // Autour de wait(): époque impaire puis paire
+    
+    // Livraisons entre shards
+    void _drainInbox();                     // Mettre en file les messages reçus
+    void _sendOutgoing();                   // Publier les lots préparés pendant l'itération
+    
+    static void* _threadMain(void* arg);
+};
+
+#endif
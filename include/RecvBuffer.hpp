@@ -0,0 +1,52 @@
+#ifndef RECVBUFFER_HPP
+#define RECVBUFFER_HPP
+
+#include <cstddef>
+#include <sys/uio.h>
+#include "StringRef.hpp"
+
+// Taille maximale d'une ligne IRC, CRLF compris (RFC 1459)
+#define IRC_MAX_LINE 512
+
+// Buffer circulaire de réception à capacité fixe (la RecvQ du client)
+// recv() écrit directement dedans; les lignes sont découpées sur place.
+class RecvBuffer {
+private:
+    char* _buffer;                          // Zone circulaire (capacité = puissance de 2)
+    size_t _capacity;
+    size_t _mask;                           // _capacity - 1
+    size_t _head;                           // Début de la ligne en cours (compteur croissant)
+    size_t _tail;                           // Fin des données reçues (compteur croissant)
+    size_t _scan;                           // Position déjà explorée à la recherche de '\n'
+    bool _discarding;                       // Ignorer jusqu'au prochain '\n' (ligne trop longue)
+    char _scratch[IRC_MAX_LINE];            // Copie d'une ligne qui chevauche la fin du buffer
+
+    RecvBuffer(const RecvBuffer&);
+    RecvBuffer& operator=(const RecvBuffer&);
+
+    bool _findNewline(size_t& pos);
+
+public:
+    // Résultat de nextLine()
+    enum LineStatus {
+        LINE_NONE,                          // Pas de ligne complète
+        LINE_OK,                            // Ligne extraite (sans CR/LF)
+        LINE_TOO_LONG                       // Ligne > IRC_MAX_LINE, ignorée
+    };
+
+    explicit RecvBuffer(size_t capacity);   // Arrondie à la puissance de 2 supérieure
+    ~RecvBuffer();
+
+    size_t size() const { return _tail - _head; }
+    size_t capacity() const { return _capacity; }
+    bool full() const { return size() == _capacity; }
+
+    // Zones libres pour readv() (0, 1 ou 2 segments), puis validation des octets lus
+    int writableRegions(struct iovec iov[2]);
+    void commit(size_t bytes);
+
+    // Extraire la prochaine ligne; la vue reste valide jusqu'au prochain appel
+    LineStatus nextLine(StringRef& line);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef SENDQUEUE_HPP
+#define SENDQUEUE_HPP
+
+#include <string>
+#include <deque>
+#include <cstddef>
+#include "SharedBuffer.hpp"
+
+struct iovec;
+
+// Nombre maximal de messages regroupés par appel à sendmsg()
+#define SENDQUEUE_MAX_IOV 64
+
+// Taille minimale d'un bloc privé rempli par append() (réponses propres au client)
+#define SENDQUEUE_APPEND_BLOCK 1024
+
+// File d'attente d'envoi d'un client
+// Chaîne de références vers des messages partagés, envoyée en un seul sendmsg() vectorisé (MSG_NOSIGNAL);
+// seul le premier message peut être partiellement envoyé. Les réponses propres au client
+// sont copiées à la suite les unes des autres dans des blocs privés (append).
+class SendQueue {
+private:
+    std::deque<SharedBuffer> _chunks;       // Messages en attente (références partagées)
+    size_t _offset;                         // Octets déjà envoyés du premier message
+    size_t _bytes;                          // Total d'octets restant à envoyer
+
+public:
+    // Résultat d'un flush()
+    enum FlushResult {
+        FLUSH_DONE,                         // File vidée
+        FLUSH_PARTIAL,                      // Le socket est plein, il reste des données
+        FLUSH_ERROR                         // Erreur fatale sur le socket (errno positionné)
+    };
+
+    SendQueue();
+
+    void push(const SharedBuffer& message);
+    void append(const char* data, size_t length); // Copie, regroupée dans un bloc privé
+    bool empty() const { return _bytes == 0; }
+    size_t size() const { return _bytes; }
+    size_t chunkCount() const { return _chunks.size(); }
+    void clear();
+    void clearUnsent();                     // Comme clear(), sauf la fin du message entamé
+
+    // Envoyer autant que possible sur fd (non-bloquant)
+    FlushResult flush(int fd, size_t* bytes_sent = NULL);
+
+    // Envoi fait par l'appelant (lots): segments du début de la file, puis retrait des octets partis
+    int prepare(struct iovec* iov, int max_count, size_t* length) const;
+    void consume(size_t sent);
+};
+
+#endif
@@ -5,75 +5,119 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <pthread.h>
 
 // Headers système pour les sockets (Unix/Linux)
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
-#include <poll.h>
 #include <fcntl.h>
 #include <unistd.h>
 
+#include "ServerConfig.hpp"
+#include "SharedBuffer.hpp"
+#include "StringRef.hpp"
+#include "NumericReply.hpp"
+#include "ShardedCaseMap.hpp"
+#include "HistoryStore.hpp"
+#include "ObjectPool.hpp"
+#include "Channel.hpp"
+
 // Forward declarations pour éviter les inclusions circulaires
 class Client;
-class Channel;
+class Reactor;
+class MetricsExporter;
+struct MetricsSnapshot;
+
+// Relevé d'un client pour STATS l, copié sous le verrou de sa part d'index
+struct ClientSummary {
+    std::string nickname;
+    std::string username;
+    std::string hostname;
+    Client* client;                         // getQueuedBytes() se lit depuis tout thread
+};
 
+// État IRC partagé (nicknames, channels, liens) et shards d'E/S
+// Les handlers de commandes s'exécutent depuis le thread du reactor qui possède le
+// client émetteur, sans verrou global: chaque channel a son verrou, les index de noms
+// sont découpés en parts verrouillées séparément (voir l'ordre dans Server.cpp).
 class Server {
+    friend class Reactor;
+    friend struct ServerBench;              // Microbenchmarks (tools/microbench.cpp)
+
 private:
     // Configuration du serveur
     int _port;                              // Port d'écoute
     std::string _password;                  // Mot de passe du serveur
+    ServerConfig _config;                   // Options de démarrage
     
-    // Socket et réseau
-    int _server_fd;                         // File descriptor du socket serveur
-    struct sockaddr_in _server_addr;        // Adresse du serveur
-    
-    // Gestion des clients
-    std::vector<struct pollfd> _poll_fds;   // Array pour poll()
-    std::map<int, Client*> _clients;        // Map fd -> Client*
+    // Shards d'E/S (un thread chacun, le premier tourne dans start())
+    std::vector<Reactor*> _reactors;
+    MetricsExporter* _metrics_exporter;     // Listener Prometheus (optionnel)
     
-    // Gestion des channels
-    std::map<std::string, Channel*> _channels; // Map nom -> Channel*
+    // État partagé
+    ShardedCaseMap<Client*> _nicknames;     // Nickname (casse normalisée) -> Client*
+    ShardedCaseMap<Channel*> _channels;     // Nom (casse normalisée) -> Channel* vivant
+    pthread_mutex_t _channel_pool_lock;
+    ObjectPool<Channel> _channel_pool;      // Cases des Channel (max-channels)
+    HistoryStore _history;                  // Historiques des channels et budget mémoire (son verrou)
     
     // État du serveur
-    bool _running;                          // Serveur en marche ?
+    unsigned long _channel_count;           // Jauge atomique (métriques)
+    int _client_count;                      // Clients de tous les shards, borné par max-clients (atomique)
+    unsigned long _listen_overflows;        // ListenOverflows, relevé chaque seconde par le reactor 0
+    long _start_ms;                         // Horloge monotone au démarrage
+    int _running;                           // Serveur en marche ? (atomique)
 
 public:
     // Constructeur/Destructeur
-    Server(int port, const std::string& password);
+    Server(int port, const std::string& password, const ServerConfig& config = ServerConfig());
     ~Server();
     
     // Méthodes principales
     void start();                           // Démarrer le serveur
     void stop();                            // Arrêter le serveur
+    bool isRunning() const { return __atomic_load_n(&_running, __ATOMIC_ACQUIRE) != 0; }
+    
+    int getPort() const { return _port; }
+    const ServerConfig& getConfig() const { return _config; }
+    size_t getReactorCount() const { return _reactors.size(); }
+    Reactor* getReactor(size_t index) const { return _reactors[index]; }
+    void collectMetrics(MetricsSnapshot& snapshot) const; // Thread-safe, sans verrou
     
 public:
-    // Méthodes publiques pour les commandes
-    void sendResponse(Client* client, const std::string& response);
-    Channel* getOrCreateChannel(const std::string& name);
-    void removeEmptyChannel(const std::string& name);
-    Client* findClientByNickname(const std::string& nickname);
+    // Méthodes publiques pour les commandes (thread d'un reactor)
+    void sendResponse(Client* client, const StringRef& response);
+    void sendNumeric(Client* client, NumericId id, const StringRef& arg1 = StringRef(),
+                     const StringRef& arg2 = StringRef(), const StringRef& arg3 = StringRef());
+    void sendMessage(Client* client, const SharedBuffer& message);
+    void deliver(const std::vector<Client*>& recipients, const StringRef& message); // Encodé une fois
+    void deliver(const std::vector<Client*>& recipients, const SharedBuffer& message);
+    Channel* findChannel(const StringRef& name);     // NULL si absent (aucune allocation), non verrouillé
+    Channel* createChannel(const std::string& name); // Existant ou nouveau; NULL si max-channels est atteint
+    Channel* lockChannel(const StringRef& name, bool create = false); // Channel vivant, verrou pris
+    void removeFromChannel(Channel* channel, Client* client); // Sous le verrou; supprime le channel s'il devient vide
+    // Sous le verrou du channel
+    void recordHistory(Channel* channel, const SharedBuffer& line) { _history.record(channel->getHistory(), line); }
+    void selectHistory(Channel* channel, HistoryQuery query, long long time_ms, size_t limit,
+                       std::vector<SharedBuffer>& out) { _history.select(channel->getHistory(), query, time_ms, limit, out); }
+    size_t getHistoryMaxLines() const { return _history.getMaxLines(); }
+    Client* findClientByNickname(const StringRef& nickname); // Valide jusqu'à la fin de l'itération
+    void listClients(std::vector<ClientSummary>& out); // Clients enregistrés
+    bool changeNickname(Client* client, const std::string& nickname); // false si déjà pris
     const std::string& getPassword() const { return _password; }
 
 private:
-    // Méthodes d'initialisation
-    void _setupSocket();                    // Créer et configurer le socket
-    void _bindAndListen();                  // Bind + listen
-    
-    // Boucle principale
-    void _runEventLoop();                   // Boucle poll() principale
-    
-    // Gestion des connexions
-    void _acceptNewClient();                // Accepter nouvelle connexion
-    void _handleClientData(int client_fd);  // Traiter données d'un client
-    void _disconnectClient(int client_fd);  // Déconnecter un client
-    
-    // Traitement des commandes IRC
-    void _parseCommand(Client* client, const std::string& message);
-    
-    // Utilitaires
-    void _addToPoll(int fd, short events);  // Ajouter FD à poll()
-    void _removeFromPoll(int fd);           // Supprimer FD de poll()
+    // Appelés par les reactors
+    int _parseCommand(Client* client, const StringRef& message); // Retourne le coût de flood
+    void _detachClient(Client* client, const std::string& reason);
+    void _leaveAllChannels(Client* client, const std::string& reason); // QUIT + détacher les liens
+    void _retireChannel(Channel* channel);  // Sous le verrou du channel vidé
+    void _destroyChannel(Channel* channel); // Après la période de grâce
+    bool _reserveClient();                  // false si max-clients est atteint
+    void _releaseClient();
+    void _countErrorReply(const StringRef& response);
+    void _joinThreads();
 };
 
 #endif
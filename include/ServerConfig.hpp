@@ -0,0 +1,48 @@
+#ifndef SERVERCONFIG_HPP
+#define SERVERCONFIG_HPP
+
+#include <string>
+#include <sys/socket.h>  // pour SOMAXCONN
+#include "Logger.hpp"
+
+// Options de démarrage du serveur (ligne de commande: --clé=valeur)
+struct ServerConfig {
+    std::string engine;                     // Backend d'événements ("io_uring", "epoll" ou "poll")
+    int flush_delay_ms;                     // Fenêtre de micro-batching des envois (0 = fin d'itération)
+    int recvq_bytes;                        // Capacité du buffer de réception par client
+    int sendq_bytes;                        // Plafond de SendQ: au-delà, déconnexion
+    int sendq_soft_bytes;                   // Seuil bas: au-delà, lecture suspendue (0 = plafond / 2)
+    int flood_burst;                        // Jetons de flood disponibles d'un coup
+    int flood_rate;                         // Jetons regagnés par seconde (0 = pas de contrôle)
+    bool flood_disconnect;                  // RecvQ pleine de lignes en attente: déconnecter (sinon bloquer la lecture)
+    int listen_backlog;                     // File d'attente du listener (plafonnée par somaxconn)
+    int accept_batch;                       // Connexions acceptées au plus par itération et par shard
+    int registration_timeout;               // Secondes pour finir PASS/NICK/USER (0 = illimité)
+    int ping_interval;                      // Inactivité avant un PING du serveur, en secondes (0 = jamais)
+    int ping_timeout;                       // Délai de réponse à ce PING, en secondes
+    int threads;                            // Nombre de reactors (un thread et un listener chacun)
+    int max_clients;                        // Clients simultanés, tous shards confondus (0 = illimité)
+    int max_channels;                       // Channels simultanés (taille du pool)
+    int history_lines;                      // Messages conservés par channel (0 = pas d'historique)
+    int history_bytes;                      // Octets conservés par channel
+    int history_budget;                     // Octets d'historique pour tout le serveur
+    int history_replay;                     // Messages rejoués à l'arrivée sur un channel
+    int log_level;                          // Niveau minimal journalisé (LogLevel)
+    unsigned log_categories;                // Catégories journalisées (masque LogCategory)
+    int metrics_port;                       // Port local des métriques Prometheus (0 = désactivé)
+    std::string oper_password;              // Mot de passe OPER (vide = OPER désactivé)
+
+    ServerConfig() : engine("epoll"), flush_delay_ms(0), recvq_bytes(8192), sendq_bytes(1 << 20), 
+                     sendq_soft_bytes(0), flood_burst(10), flood_rate(5), flood_disconnect(true), 
+                     listen_backlog(SOMAXCONN), accept_batch(64), 
+                     registration_timeout(60), ping_interval(120), ping_timeout(60), threads(1), 
+                     max_clients(0), max_channels(1024), 
+                     history_lines(100), history_bytes(32768), history_budget(16 << 20), history_replay(20), 
+                     log_level(LOG_LEVEL_INFO), log_categories(LOG_ALL), 
+                     metrics_port(0) {}
+
+    // Appliquer une option "--clé=valeur", retourne false si inconnue/invalide
+    bool parseOption(const std::string& option);
+};
+
+#endif
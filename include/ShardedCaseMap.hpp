@@ -0,0 +1,85 @@
+#ifndef SHARDEDCASEMAP_HPP
+#define SHARDEDCASEMAP_HPP
+
+#include <vector>
+#include <cstddef>
+#include <pthread.h>
+#include "CaseMap.hpp"
+#include "LockGuard.hpp"
+
+#define NAME_SHARDS 64                      // Parts d'un index de noms (puissance de 2)
+#define CACHE_LINE_SIZE 64
+
+// Index de noms partagé par les reactors, découpé en parts ayant chacune son verrou
+// Deux noms ne se disputent un verrou que s'ils tombent dans la même part. Les
+// valeurs trouvées restent utilisables jusqu'à la fin de l'itération du reactor
+// appelant: un objet retiré de l'index n'est libéré qu'après (Reactor::retire).
+template <typename T>
+class ShardedCaseMap {
+public:
+    struct Shard {
+        pthread_mutex_t lock;
+        CaseMap<T> map;
+        char padding[CACHE_LINE_SIZE];      // Verrous voisins sur des lignes de cache distinctes
+    };
+
+private:
+    Shard _shards[NAME_SHARDS];
+
+    ShardedCaseMap(const ShardedCaseMap&);
+    ShardedCaseMap& operator=(const ShardedCaseMap&);
+
+public:
+    ShardedCaseMap() {
+        for (size_t i = 0; i < NAME_SHARDS; ++i) {
+            pthread_mutex_init(&_shards[i].lock, NULL);
+        }
+    }
+    ~ShardedCaseMap() {
+        for (size_t i = 0; i < NAME_SHARDS; ++i) {
+            pthread_mutex_destroy(&_shards[i].lock);
+        }
+    }
+
+    // Bits hauts du hash: les bits bas choisissent déjà le bucket dans la part
+    Shard& shardFor(const StringRef& key) {
+        return _shards[(CaseMap<T>::hash(key) >> 20) & (NAME_SHARDS - 1)];
+    }
+    Shard& shard(size_t index) { return _shards[index]; }
+    size_t shardCount() const { return NAME_SHARDS; }
+
+    // Valeur associée au nom, T() si absent
+    T find(const StringRef& key) {
+        Shard& shard = shardFor(key);
+        LockGuard guard(&shard.lock);
+        T* found = shard.map.find(key);
+        return found != NULL ? *found : T();
+    }
+
+    // Retirer le nom s'il désigne encore value
+    void erase(const StringRef& key, const T& value) {
+        Shard& shard = shardFor(key);
+        LockGuard guard(&shard.lock);
+        T* found = shard.map.find(key);
+        if (found != NULL && *found == value) {
+            shard.map.erase(key);
+        }
+    }
+
+    // Copier toutes les valeurs, part par part (nettoyage, statistiques)
+    void values(std::vector<T>& out) {
+        for (size_t i = 0; i < NAME_SHARDS; ++i) {
+            LockGuard guard(&_shards[i].lock);
+            _shards[i].map.values(out);
+        }
+    }
+
+    void clear() {
+        for (size_t i = 0; i < NAME_SHARDS; ++i) {
+            LockGuard guard(&_shards[i].lock);
+            _shards[i].map.clear();
+        }
+    }
+};
+
+#endif
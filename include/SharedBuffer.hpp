@@ -0,0 +1,41 @@
+#ifndef SHAREDBUFFER_HPP
+#define SHAREDBUFFER_HPP
+
+#include <string>
+#include <cstddef>
+
+// Message encodé immuable, partagé par compteur de références
+// Un broadcast encode la ligne une seule fois; chaque membre n'en garde qu'une référence.
+// Les copies peuvent vivre sur plusieurs shards: le compteur est atomique.
+class SharedBuffer {
+private:
+    struct Block {
+        int refcount;                       // Nombre de SharedBuffer pointant ce bloc (atomique)
+        size_t length;                      // Taille des données
+        size_t capacity;                    // Octets alloués pour les données
+        char data[1];                       // Données (allouées à la suite du bloc)
+    };
+    Block* _block;
+
+    void _init(const char* data, size_t length, size_t capacity);
+    void _release();
+
+public:
+    SharedBuffer() : _block(NULL) {}
+    explicit SharedBuffer(const std::string& data);
+    SharedBuffer(const char* data, size_t length);
+    SharedBuffer(const SharedBuffer& other);
+    SharedBuffer& operator=(const SharedBuffer& other);
+    ~SharedBuffer();
+
+    const char* data() const { return _block ? _block->data : ""; }
+    size_t size() const { return _block ? _block->length : 0; }
+    bool empty() const { return size() == 0; }
+    int useCount() const { return _block ? __atomic_load_n(&_block->refcount, __ATOMIC_RELAXED) : 0; }
+
+    // Bloc vide de capacity octets, complété par tryAppend() tant qu'il n'est pas partagé
+    static SharedBuffer reserve(size_t capacity);
+    bool tryAppend(const char* data, size_t length);
+};
+
+#endif
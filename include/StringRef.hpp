@@ -0,0 +1,35 @@
+#ifndef STRINGREF_HPP
+#define STRINGREF_HPP
+
+#include <string>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+
+// Vue non-propriétaire sur une suite d'octets (équivalent C++98 de string_view)
+// Valide tant que le buffer pointé n'est pas modifié.
+struct StringRef {
+    const char* data;
+    size_t length;
+
+    StringRef() : data(""), length(0) {}
+    StringRef(const char* d, size_t len) : data(d), length(len) {}
+    StringRef(const char* s) : data(s), length(std::strlen(s)) {}
+    StringRef(const std::string& s) : data(s.data()), length(s.length()) {}
+
+    bool empty() const { return length == 0; }
+    size_t size() const { return length; }
+    char operator[](size_t i) const { return data[i]; }
+    std::string str() const { return std::string(data, length); }
+
+    bool operator==(const StringRef& other) const {
+        return length == other.length && std::memcmp(data, other.data, length) == 0;
+    }
+    bool operator!=(const StringRef& other) const { return !(*this == other); }
+};
+
+inline std::ostream& operator<<(std::ostream& os, const StringRef& ref) {
+    return os.write(ref.data, ref.length);
+}
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TICKARENA_HPP
+#define TICKARENA_HPP
+
+#include <string>
+#include <cstddef>
+#include "StringRef.hpp"
+
+#define ARENA_CHUNK_SIZE 65536              // Taille initiale de l'arène d'un reactor
+
+// Arène d'une itération de boucle: allocation par simple incrément de pointeur,
+// tout est rendu d'un coup par reset() en fin d'itération (rien n'est libéré avant).
+// Un débordement chaîne des blocs supplémentaires; le reset suivant les fusionne
+// en un seul bloc assez grand, de sorte que le régime stable ne fait aucun malloc.
+class TickArena {
+private:
+    struct Chunk {
+        Chunk* next;                        // Bloc précédent (débordements)
+        size_t size;                        // Octets utilisables
+        size_t used;
+    };
+
+    Chunk* _current;                        // Bloc où l'on alloue
+    size_t _chunk_size;                     // Taille du bloc principal
+    size_t _total_used;                     // Octets alloués depuis le dernier reset
+    size_t _high_water;                     // Maximum observé sur une itération
+
+    TickArena(const TickArena&);
+    TickArena& operator=(const TickArena&);
+
+    static Chunk* _newChunk(size_t size, Chunk* next);
+    static char* _chunkData(Chunk* chunk) { return reinterpret_cast<char*>(chunk + 1); }
+
+public:
+    explicit TickArena(size_t chunk_size = ARENA_CHUNK_SIZE);
+    ~TickArena();
+
+    void* allocate(size_t size);            // Aligné sur 16 octets, valide jusqu'au reset()
+    void reset();                           // Fin d'itération: tout est invalidé
+
+    size_t used() const { return _total_used; }
+    size_t highWater() const { return _high_water; }
+};
+
+// Ligne de texte construite dans l'arène (réponses, messages relayés)
+// Remplace les concaténations de std::string: une seule copie finale vers un SharedBuffer.
+class LineBuilder {
+private:
+    TickArena& _arena;
+    char* _data;
+    size_t _length;
+    size_t _capacity;
+
+    LineBuilder(const LineBuilder&);
+    LineBuilder& operator=(const LineBuilder&);
+
+    void _reserve(size_t extra);
+
+public:
+    explicit LineBuilder(TickArena& arena, size_t capacity = 512);
+
+    LineBuilder& append(const char* data, size_t length);
+    LineBuilder& operator<<(const StringRef& text) { return append(text.data, text.length); }
+    LineBuilder& operator<<(const std::string& text) { return append(text.data(), text.length()); }
+    LineBuilder& operator<<(const char* text) { return append(text, std::strlen(text)); }
+    LineBuilder& operator<<(char c) { return append(&c, 1); }
+
+    const char* data() const { return _data; }
+    size_t length() const { return _length; }
+    StringRef ref() const { return StringRef(_data, _length); }
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <vector>
+#include <cstddef>
+
+#define TIMER_LEVEL0_BITS 8                 // Niveau 0: 256 cases d'une milliseconde
+#define TIMER_LEVEL_BITS 6                  // Niveaux supérieurs: 64 cases chacun
+#define TIMER_LEVELS 4                      // Portée: 2^26 ms (~18 h)
+
+#define TIMER_LEVEL0_SIZE (1 << TIMER_LEVEL0_BITS)
+#define TIMER_LEVEL_SIZE (1 << TIMER_LEVEL_BITS)
+
+// Timer intrusif, embarqué dans l'objet qui le possède (aucune allocation pour l'armer)
+// type et owner permettent au propriétaire de la roue d'aiguiller l'expiration.
+struct Timer {
+    Timer* next;
+    Timer** pprev;                          // Maillon qui pointe sur nous (NULL: non armé)
+    long expires_ms;                        // Échéance (horloge monotone)
+    int level;                              // Niveau de la roue où il est rangé
+    int type;
+    void* owner;
+
+    Timer(int timer_type = 0, void* timer_owner = NULL)
+        : next(NULL), pprev(NULL), expires_ms(0), level(0), type(timer_type), owner(timer_owner) {}
+
+    bool armed() const { return pprev != NULL; }
+};
+
+// Roue de timers hiérarchique à la milliseconde: armer et annuler en O(1)
+// Le niveau 0 range les échéances des 256 prochaines ms, une case par ms; chaque
+// niveau supérieur couvre 64 fois la portée du précédent. Quand le niveau 0 fait
+// un tour, la case suivante du niveau 1 est redistribuée (cascade), et ainsi de suite:
+// un timer n'est déplacé qu'au plus TIMER_LEVELS - 1 fois, sans jamais parcourir
+// l'ensemble des timers armés. Au-delà de la portée, l'échéance est avancée:
+// le propriétaire vérifie son état à l'expiration et réarme.
+// Non thread-safe: une roue par reactor.
+class TimerWheel {
+private:
+    Timer* _level0[TIMER_LEVEL0_SIZE];
+    Timer* _levels[TIMER_LEVELS - 1][TIMER_LEVEL_SIZE];
+    size_t _counts[TIMER_LEVELS];           // Timers armés par niveau
+    size_t _count;
+    long _current_ms;                       // Prochaine milliseconde à traiter
+
+    TimerWheel(const TimerWheel&);
+    TimerWheel& operator=(const TimerWheel&);
+
+    void _insert(Timer* timer);
+    void _unlink(Timer* timer);
+    void _cascade();
+
+    static int _shift(int level) { return TIMER_LEVEL0_BITS + (level - 1) * TIMER_LEVEL_BITS; }
+
+public:
+    explicit TimerWheel(long now_ms);
+
+    void schedule(Timer* timer, long expires_ms); // Arme (ou réarme) le timer
+    void cancel(Timer* timer);                    // Sans effet s'il n'est pas armé
+
+    // Faire avancer la roue jusqu'à now_ms: les timers échus sont désarmés et ajoutés à expired
+    void advance(long now_ms, std::vector<Timer*>& expired);
+
+    // Prochaine échéance (au plus tôt), -1 si aucun timer n'est armé
+    // Pour un timer des niveaux supérieurs, c'est l'instant de sa cascade.
+    long nextExpiry() const;
+
+    size_t size() const { return _count; }
+    bool empty() const { return _count == 0; }
+};
+
+#endif
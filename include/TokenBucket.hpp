@@ -0,0 +1,40 @@
+#ifndef TOKENBUCKET_HPP
+#define TOKENBUCKET_HPP
+
+// Seau à jetons du contrôle de flood (un par client)
+// Le crédit est compté en millièmes de jeton: un débit en jetons/s se remplit
+// alors d'un nombre entier d'unités par milliseconde. Il peut devenir négatif:
+// une commande coûteuse passe, puis le client attend d'avoir remboursé sa dette.
+class TokenBucket {
+private:
+    long _credit;                           // Millièmes de jeton disponibles
+    long _updated_ms;                       // Horloge monotone du dernier remplissage
+
+public:
+    TokenBucket() : _credit(0), _updated_ms(0) {}
+
+    // Seau plein (nouvelle connexion)
+    void reset(long burst, long now_ms) {
+        _credit = burst * 1000;
+        _updated_ms = now_ms;
+    }
+
+    // Ajouter les jetons gagnés depuis le dernier appel, sans dépasser burst
+    void refill(long now_ms, long rate, long burst) {
+        _credit += (now_ms - _updated_ms) * rate;
+        if (_credit > burst * 1000) {
+            _credit = burst * 1000;
+        }
+        _updated_ms = now_ms;
+    }
+
+    bool available() const { return _credit > 0; }
+    void consume(int cost) { _credit -= cost * 1000L; }
+
+    // Délai avant que le crédit redevienne positif
+    long msUntilAvailable(long rate) const {
+        return available() ? 0 : (-_credit) / rate + 1;
+    }
+};
+
+#endif
@@ -6,12 +6,14 @@
 // Forward declarations
 class Server;
 class Client;
+struct IrcMessage;
 
 class AuthCommands {
 public:
-    static void handlePass(Server* server, Client* client, const std::string& args);
-    static void handleNick(Server* server, Client* client, const std::string& args);
-    static void handleUser(Server* server, Client* client, const std::string& args);
+    static void handlePass(Server* server, Client* client, const IrcMessage& msg);
+    static void handleNick(Server* server, Client* client, const IrcMessage& msg);
+    static void handleUser(Server* server, Client* client, const IrcMessage& msg);
+    static void handleOper(Server* server, Client* client, const IrcMessage& msg);
     
 private:
     static void sendWelcomeMessages(Server* server, Client* client);
@@ -6,14 +6,16 @@
 // Forward declarations
 class Server;
 class Client;
+struct IrcMessage;
 
 class ChannelCommands {
 public:
-    static void handleJoin(Server* server, Client* client, const std::string& args);
-    static void handleKick(Server* server, Client* client, const std::string& args);
-    static void handleInvite(Server* server, Client* client, const std::string& args);
-    static void handleTopic(Server* server, Client* client, const std::string& args);
-    static void handleMode(Server* server, Client* client, const std::string& args);
+    static void handleJoin(Server* server, Client* client, const IrcMessage& msg);
+    static void handleKick(Server* server, Client* client, const IrcMessage& msg);
+    static void handlePart(Server* server, Client* client, const IrcMessage& msg);
+    static void handleInvite(Server* server, Client* client, const IrcMessage& msg);
+    static void handleTopic(Server* server, Client* client, const IrcMessage& msg);
+    static void handleMode(Server* server, Client* client, const IrcMessage& msg);
 };
 
 #endif 
\ No newline at end of file
@@ -6,10 +6,12 @@
 // Forward declarations
 class Server;
 class Client;
+struct IrcMessage;
 
 class MessageCommands {
 public:
-    static void handlePrivmsg(Server* server, Client* client, const std::string& args);
+    static void handlePrivmsg(Server* server, Client* client, const IrcMessage& msg);
+    static void handleChathistory(Server* server, Client* client, const IrcMessage& msg);
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef SERVERCOMMANDS_HPP
+#define SERVERCOMMANDS_HPP
+
+#include <string>
+
+// Forward declarations
+class Server;
+class Client;
+struct IrcMessage;
+struct MetricsSnapshot;
+
+class ServerCommands {
+public:
+    static void handleStats(Server* server, Client* client, const IrcMessage& msg);
+    static void handlePing(Server* server, Client* client, const IrcMessage& msg);
+    static void handlePong(Server* server, Client* client, const IrcMessage& msg);
+
+private:
+    static void sendCommandStats(Server* server, Client* client, const MetricsSnapshot& snapshot);
+    static void sendErrorStats(Server* server, Client* client, const MetricsSnapshot& snapshot);
+    static void sendTrafficStats(Server* server, Client* client, const MetricsSnapshot& snapshot);
+    static void sendSendqStats(Server* server, Client* client, const MetricsSnapshot& snapshot);
+    static void sendLinkInfo(Server* server, Client* client);
+    static void sendUptime(Server* server, Client* client, const MetricsSnapshot& snapshot);
+};
+
+#endif
@@ -2,13 +2,77 @@
 #define UTILS_HPP
 
 #include <string>
-#include <sstream>
+#include <ctime>
+#include "StringRef.hpp"
+
+#define INTEGER_MAX_DIGITS 24              // Signe et chiffres d'un entier 64 bits
+
+// Écrire value en décimal juste avant end, sans flux ni allocation; retourne le début
+// Les chiffres d'un négatif sont pris un à un (pas de -value: débordement sur le minimum).
+template <typename T>
+inline char* formatInteger(char* end, T value) {
+    bool negative = value < 1 && value != 0; // Sans avertissement pour les types non signés
+    char* p = end;
+    do {
+        int digit = static_cast<int>(value % 10);
+        *--p = static_cast<char>('0' + (negative ? -digit : digit));
+        value /= 10;
+    } while (value != 0);
+    if (negative) {
+        *--p = '-';
+    }
+    return p;
+}
 
 // Fonction utilitaire C++98 pour convertir int en string
-inline std::string intToString(int value) {
-    std::ostringstream oss;
-    oss << value;
-    return oss.str();
+template <typename T>
+inline std::string intToString(T value) {
+    char buffer[INTEGER_MAX_DIGITS];
+    char* end = buffer + sizeof(buffer);
+    char* start = formatInteger(end, value);
+    return std::string(start, end - start);
+}
+
+// Horloge monotone en millisecondes
+inline long monotonicMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+// Heure murale en millisecondes depuis l'epoch (horodatage de l'historique)
+inline long long realtimeMs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000L;
+}
+
+// Horloge monotone en nanosecondes (mesures de durée)
+inline long long monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Minuscule selon le casemapping RFC 1459: {}|~ sont les minuscules de []\^
+inline char ircToLower(char c) {
+    if (c >= 'A' && c <= '^') {
+        return c + ('a' - 'A');
+    }
+    return c;
+}
+
+// Comparer deux noms IRC (nicknames, channels) sans tenir compte de la casse
+inline bool ircEqualsIgnoreCase(const StringRef& a, const StringRef& b) {
+    if (a.length != b.length) {
+        return false;
+    }
+    for (size_t i = 0; i < a.length; ++i) {
+        if (ircToLower(a[i]) != ircToLower(b[i])) {
+            return false;
+        }
+    }
+    return true;
 }
 
-#endif 
\ No newline at end of file
+#endif
@@ -1,122 +1,127 @@
 #include "Channel.hpp"
 #include "Client.hpp"
-#include <algorithm>
-#include <iostream>
-#include <sys/socket.h>  // Pour send()
-#include <unistd.h>      // Pour ssize_t
+#include "Logger.hpp"
 
 // Constructeur : créer un nouveau channel
 Channel::Channel(const std::string& name) 
-    : _name(name), _topic(""), _invite_only(false), _topic_restricted(false), _key(""), _user_limit(0) {
+    : _dead(false), _name(name), _topic(""), _invite_only(false), _topic_restricted(false), _key(""), _user_limit(0) {
     
-    std::cout << "Creating new channel: " << _name << std::endl;
+    pthread_mutex_init(&_lock, NULL);
+    LOG_DEBUG(LOG_CHAN, "Creating new channel: " << _name);
 }
 
-// Destructeur
+// Destructeur : détacher et libérer les liens restants
 Channel::~Channel() {
-    std::cout << "Destroying channel: " << _name << std::endl;
+    LOG_DEBUG(LOG_CHAN, "Destroying channel: " << _name);
+    
+    for (size_t i = 0; i < _members.size(); ++i) {
+        _members[i]->client->detachMembership(_members[i]);
+        delete _members[i];
+    }
+    pthread_mutex_destroy(&_lock);
 }
 
 // Ajouter un membre au channel
-void Channel::addMember(Client* client, bool is_operator) {
+// Retourne le lien créé (ou existant), NULL si le channel est plein
+Membership* Channel::addMember(Client* client, bool is_operator) {
     // Vérifier si déjà membre
-    if (isMember(client)) {
-        std::cout << "Client " << client->getNickname() << " already in channel " << _name << std::endl;
-        return;
+    Membership* existing = findMembership(client);
+    if (existing != NULL) {
+        LOG_DEBUG(LOG_CHAN, "Client " << client->getNickname() << " already in channel " << _name);
+        return existing;
     }
     
     // Vérifier la limite d'utilisateurs
     if (_user_limit > 0 && _members.size() >= static_cast<size_t>(_user_limit)) {
-        std::cout << "Channel " << _name << " is full (limit: " << _user_limit << ")" << std::endl;
-        return; // Channel plein
+        LOG_DEBUG(LOG_CHAN, "Channel " << _name << " is full (limit: " << _user_limit << ")");
+        return NULL; // Channel plein
     }
     
-    // Ajouter à la liste des membres
-    _members.push_back(client);
-    
-    // Définir les droits d'opérateur
-    _operators[client] = is_operator;
+    // Créer le lien unique, avec ses droits d'opérateur
+    Membership* membership = new Membership;
+    membership->client = client;
+    membership->channel = this;
+    membership->modes = is_operator ? MEMBER_OPERATOR : 0;
+    membership->channel_slot = _members.size();
+    _members.push_back(membership);
+    _member_index[client] = membership;
     
-    // Ajouter le channel à la liste du client
-    client->joinChannel(_name);
+    // L'enregistrer aussi côté client
+    client->attachMembership(membership);
     
-    std::cout << "Client " << client->getNickname() << " joined channel " << _name;
-    if (is_operator) {
-        std::cout << " (operator)";
-    }
-    std::cout << std::endl;
+    LOG_DEBUG(LOG_CHAN, "Client " << client->getNickname() << " joined channel " << _name 
+              << (is_operator ? " (operator)" : ""));
+    return membership;
 }
 
-// Supprimer un membre du channel
-void Channel::removeMember(Client* client) {
-    // Chercher le client dans la liste
-    std::vector<Client*>::iterator it = std::find(_members.begin(), _members.end(), client);
+// Détacher un lien des deux côtés en O(1), puis le libérer
+void Channel::removeMembership(Membership* membership) {
+    Client* client = membership->client;
     
-    if (it != _members.end()) {
-        // Supprimer de la liste des membres
-        _members.erase(it);
-        
-        // Supprimer des opérateurs
-        _operators.erase(client);
-        
-        // Supprimer le channel de la liste du client
-        client->leaveChannel(_name);
-        
-        std::cout << "Client " << client->getNickname() << " left channel " << _name << std::endl;
-    } else {
-        std::cout << "Client " << client->getNickname() << " was not in channel " << _name << std::endl;
+    // Le dernier membre prend la place libérée
+    size_t slot = membership->channel_slot;
+    if (slot != _members.size() - 1) {
+        _members[slot] = _members.back();
+        _members[slot]->channel_slot = slot;
     }
+    _members.pop_back();
+    _member_index.erase(client);
+    
+    client->detachMembership(membership);
+    delete membership;
+    
+    LOG_DEBUG(LOG_CHAN, "Client " << client->getFd() << " left channel " << _name); // Peut être d'un autre shard (KICK)
+}
+
+// Trouver le lien d'un client (NULL si pas membre)
+Membership* Channel::findMembership(Client* client) const {
+    std::tr1::unordered_map<Client*, Membership*>::const_iterator it = _member_index.find(client);
+    return it != _member_index.end() ? it->second : NULL;
 }
 
 // Vérifier si un client est membre du channel
 bool Channel::isMember(Client* client) const {
-    return std::find(_members.begin(), _members.end(), client) != _members.end();
+    return findMembership(client) != NULL;
 }
 
 // Vérifier si un client est opérateur du channel
 bool Channel::isOperator(Client* client) const {
-    std::map<Client*, bool>::const_iterator it = _operators.find(client);
-    return (it != _operators.end() && it->second);
+    const Membership* membership = findMembership(client);
+    return membership != NULL && (membership->modes & MEMBER_OPERATOR);
 }
 
-// Diffuser un message à tous les membres du channel
-void Channel::broadcastMessage(const std::string& message, Client* sender) {
-    std::cout << "Broadcasting to channel " << _name << ": " << message;
-    
-    // Envoyer à tous les membres (sauf l'expéditeur si spécifié)
-    for (std::vector<Client*>::iterator it = _members.begin(); it != _members.end(); ++it) {
-        Client* member = *it;
-        
-        // Si sender est NULL, envoyer à tous
-        // Si sender est spécifié, ne pas renvoyer le message à l'expéditeur
-        if (sender == NULL || member != sender) {
-            member->appendToSendBuffer(message);
-            
-            // Essayer d'envoyer immédiatement
-            const std::string& send_buffer = member->getSendBuffer();
-            if (!send_buffer.empty()) {
-                ssize_t bytes_sent = send(member->getFd(), send_buffer.c_str(), send_buffer.length(), 0);
-                
-                if (bytes_sent > 0) {
-                    member->clearSendBuffer(bytes_sent);
-                }
-            }
+// Vérifier si un client a la voix sur le channel
+bool Channel::isVoiced(Client* client) const {
+    const Membership* membership = findMembership(client);
+    return membership != NULL && (membership->modes & MEMBER_VOICE);
+}
+
+// Relever les destinataires d'une diffusion (sauf except si spécifié)
+// Les envois se font après avoir relâché le verrou: un membre lent ou d'un autre
+// shard ne retient jamais le channel.
+void Channel::collectMembers(std::vector<Client*>& out, Client* except) const {
+    out.reserve(out.size() + _members.size());
+    for (std::vector<Membership*>::const_iterator it = _members.begin(); it != _members.end(); ++it) {
+        if ((*it)->client != except) {
+            out.push_back((*it)->client);
         }
     }
 }
 
 // Ajouter un opérateur
 void Channel::addOperator(Client* client) {
-    if (isMember(client)) {
-        _operators[client] = true;
-        std::cout << "Client " << client->getNickname() << " is now operator of " << _name << std::endl;
+    Membership* membership = findMembership(client);
+    if (membership != NULL) {
+        membership->modes |= MEMBER_OPERATOR;
+        LOG_DEBUG(LOG_CHAN, "Client " << client->getFd() << " is now operator of " << _name);
     }
 }
 
 // Retirer un opérateur
 void Channel::removeOperator(Client* client) {
-    if (isMember(client)) {
-        _operators[client] = false;
-        std::cout << "Client " << client->getNickname() << " is no longer operator of " << _name << std::endl;
+    Membership* membership = findMembership(client);
+    if (membership != NULL) {
+        membership->modes &= ~MEMBER_OPERATOR;
+        LOG_DEBUG(LOG_CHAN, "Client " << client->getFd() << " is no longer operator of " << _name);
     }
 } 
\ No newline at end of file
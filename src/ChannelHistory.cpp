@@ -0,0 +1,79 @@
+#include "ChannelHistory.hpp"
+#include <algorithm>  // pour std::swap
+
+ChannelHistory::ChannelHistory()
+    : _first(0), _count(0), _bytes(0), _colder(NULL), _warmer(NULL), _linked(false), _tombstone(NULL) {}
+
+// Un anneau plein double (HISTORY_RING_MIN au départ), sans dépasser capacity
+size_t ChannelHistory::_growth(size_t capacity) const {
+    if (_count < _ring.size() || _ring.size() >= capacity) {
+        return 0;
+    }
+    size_t grown = _ring.empty() ? HISTORY_RING_MIN : _ring.size() * 2;
+    return (grown < capacity ? grown : capacity) - _ring.size();
+}
+
+// Ajouter à la fin; l'appelant a déjà fait de la place si l'anneau a atteint capacity
+size_t ChannelHistory::_push(const HistoryEntry& entry, size_t capacity) {
+    size_t growth = _growth(capacity);
+    if (growth > 0) {
+        // Remettre les entrées dans l'ordre au début du nouvel anneau
+        std::vector<HistoryEntry> ring(_ring.size() + growth);
+        for (size_t i = 0; i < _count; ++i) {
+            ring[i] = at(i);
+        }
+        _ring.swap(ring);
+        _first = 0;
+    }
+    _ring[(_first + _count) % _ring.size()] = entry;
+    ++_count;
+    size_t added = entry.line.size() + growth * sizeof(HistoryEntry);
+    _bytes += added;
+    return added;
+}
+
+// Retirer l'entrée la plus ancienne (sa référence sur la ligne est rendue)
+size_t ChannelHistory::_popOldest() {
+    HistoryEntry& oldest = _ring[_first];
+    size_t freed = oldest.line.size();
+    oldest = HistoryEntry();
+    _first = (_first + 1) % _ring.size();
+    --_count;
+    _bytes -= freed;
+    return freed;
+}
+
+// Tout vider et rendre l'anneau lui-même
+size_t ChannelHistory::_clear() {
+    size_t freed = _bytes;
+    std::vector<HistoryEntry>().swap(_ring);
+    _first = 0;
+    _count = 0;
+    _bytes = 0;
+    return freed;
+}
+
+// Échanger les entrées avec un autre historique, sans copier les lignes
+void ChannelHistory::_swapContents(ChannelHistory& other) {
+    _ring.swap(other._ring);
+    std::swap(_first, other._first);
+    std::swap(_count, other._count);
+    std::swap(_bytes, other._bytes);
+}
+
+// Recherche dichotomique: les horodatages sont croissants dans l'anneau
+// Premier index dont l'horodatage dépasse time_ms (strictement si inclusive est faux)
+size_t ChannelHistory::_search(long long time_ms, bool inclusive) const {
+    size_t low = 0;
+    size_t high = _count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        long long entry_ms = at(middle).time_ms;
+        if (entry_ms < time_ms || (!inclusive && entry_ms == time_ms)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
@@ -1,40 +1,41 @@
 #include "Client.hpp"
-#include <algorithm>
-#include <iostream>
+#include "LockGuard.hpp"
+#include "Logger.hpp"
 
 // Constructeur : initialise un nouveau client
-Client::Client(int fd, const std::string& ip) 
-    : _fd(fd), _ip_address(ip), _password_ok(false), _registered(false), _authenticated(false) {
+Client::Client(int fd, const std::string& ip, size_t recvq_size) 
+    : _fd(fd), _ip_address(ip), _reactor(NULL), _id(0), _recv_buffer(recvq_size), _queued_bytes(0), _write_interest(false), _read_interest(true), 
+      _flush_pending(false), _read_suspended(false), _sendq_exceeded(false), _flood_throttled(false), 
+      _flood_timer(TIMER_FLOOD, this), _connected_ms(0), _last_active_ms(0), _ping_sent_ms(0), 
+      _keepalive_timer(TIMER_KEEPALIVE, this), _password_ok(false), _registered(false), 
+      _authenticated(false), _disconnected(false), _server_operator(false) {
     
-    std::cout << "Creating new client object for fd " << _fd << " from " << _ip_address << std::endl;
-    
-    // Initialiser les buffers vides
-    _receive_buffer.clear();
-    _send_buffer.clear();
+    LOG_DEBUG(LOG_CLIENT, "Creating new client object for fd " << _fd << " from " << _ip_address);
     
     // Pas encore de nickname/username définis
     _nickname.clear();
     _username.clear();
     _realname.clear();
     _hostname = _ip_address; // Par défaut, hostname = IP
-    
-    // Pas encore dans de channels
-    _channels.clear();
+    _updatePrefix();
+    pthread_mutex_init(&_membership_lock, NULL);
 }
 
 // Destructeur : nettoyer les ressources
 Client::~Client() {
-    std::cout << "Destroying client object for " << _nickname 
-              << " (fd: " << _fd << ")" << std::endl;
+    LOG_DEBUG(LOG_CLIENT, "Destroying client object for " << _nickname 
+              << " (fd: " << _fd << ")");
     
     // Les buffers et vectors se nettoient automatiquement
     // Le socket sera fermé par la classe Server
+    pthread_mutex_destroy(&_membership_lock);
 }
 
 // Définir le nickname et vérifier l'état d'enregistrement
 void Client::setNickname(const std::string& nick) {
     _nickname = nick;
-    std::cout << "Client " << _fd << " set nickname to: " << _nickname << std::endl;
+    _updatePrefix();
+    LOG_DEBUG(LOG_CLIENT, "Client " << _fd << " set nickname to: " << _nickname);
     
     // Vérifier si maintenant complètement enregistré
     _updateRegistrationStatus();
@@ -43,103 +44,45 @@ void Client::setNickname(const std::string& nick) {
 // Définir le username et vérifier l'état d'enregistrement
 void Client::setUsername(const std::string& user) {
     _username = user;
-    std::cout << "Client " << _fd << " set username to: " << _username << std::endl;
+    _updatePrefix();
+    LOG_DEBUG(LOG_CLIENT, "Client " << _fd << " set username to: " << _username);
     
     // Vérifier si maintenant complètement enregistré
     _updateRegistrationStatus();
 }
 
-// Ajouter des données au buffer de réception
-void Client::appendToReceiveBuffer(const std::string& data) {
-    _receive_buffer += data;
-    
-    std::cout << "Added " << data.length() << " bytes to receive buffer for client " 
-              << _fd << " (total: " << _receive_buffer.length() << " bytes)" << std::endl;
-}
-
-// Extraire un message complet du buffer de réception
-std::string Client::extractMessage() {
-    // Chercher le délimiteur de fin de ligne IRC (\n)
-    size_t pos = _receive_buffer.find('\n');
-    
-    if (pos == std::string::npos) {
-        return ""; // Pas de message complet disponible
+// Source des messages relayés, construite une fois par changement plutôt qu'à chaque envoi
+// Avant USER, seul le nickname est connu: ":nick".
+void Client::_updatePrefix() {
+    _prefix = ":" + _nickname;
+    if (!_username.empty()) {
+        _prefix += "!" + _username + "@" + _hostname;
     }
-    
-    // Extraire le message jusqu'au \n (inclus)
-    std::string message = _receive_buffer.substr(0, pos);
-    
-    // Supprimer ce message du buffer (y compris le \n)
-    _receive_buffer.erase(0, pos + 1);
-    
-    // Supprimer le \r s'il est présent à la fin du message
-    if (!message.empty() && message[message.length() - 1] == '\r') {
-        message.erase(message.length() - 1);
-    }
-    
-    std::cout << "Extracted message from client " << _fd << ": '" << message << "'" << std::endl;
-    
-    return message;
 }
 
-// Vérifier s'il y a au moins un message complet dans le buffer
-bool Client::hasCompleteMessage() const {
-    return _receive_buffer.find('\n') != std::string::npos;
+// Ajouter le lien vers un channel (appelé par Channel::addMember)
+void Client::attachMembership(Membership* membership) {
+    LockGuard guard(&_membership_lock);
+    membership->client_slot = _memberships.size();
+    _memberships.push_back(membership);
 }
 
-// Ajouter des données au buffer d'envoi
-void Client::appendToSendBuffer(const std::string& data) {
-    _send_buffer += data;
-    
-    std::cout << "Added " << data.length() << " bytes to send buffer for client " 
-              << _fd << " (total: " << _send_buffer.length() << " bytes)" << std::endl;
-}
-
-// Supprimer les bytes déjà envoyés du buffer d'envoi
-void Client::clearSendBuffer(size_t bytes_sent) {
-    if (bytes_sent >= _send_buffer.length()) {
-        // Tout a été envoyé
-        _send_buffer.clear();
-    } else {
-        // Supprimer seulement les bytes envoyés
-        _send_buffer.erase(0, bytes_sent);
-    }
-    
-    std::cout << "Cleared " << bytes_sent << " bytes from send buffer for client " 
-              << _fd << " (remaining: " << _send_buffer.length() << " bytes)" << std::endl;
-}
-
-// Rejoindre un channel
-void Client::joinChannel(const std::string& channel) {
-    // Vérifier si déjà dans ce channel
-    if (isInChannel(channel)) {
-        std::cout << "Client " << _nickname << " already in channel " << channel << std::endl;
-        return;
-    }
-    
-    // Ajouter le channel à la liste
-    _channels.push_back(channel);
-    
-    std::cout << "Client " << _nickname << " joined channel " << channel << std::endl;
-}
-
-// Quitter un channel
-void Client::leaveChannel(const std::string& channel) {
-    // Chercher le channel dans la liste
-    std::vector<std::string>::iterator it = std::find(_channels.begin(), _channels.end(), channel);
-    
-    if (it != _channels.end()) {
-        // Channel trouvé, le supprimer
-        _channels.erase(it);
-        std::cout << "Client " << _nickname << " left channel " << channel << std::endl;
-    } else {
-        std::cout << "Client " << _nickname << " was not in channel " << channel << std::endl;
+// Retirer le lien en O(1): le dernier lien prend sa place
+void Client::detachMembership(Membership* membership) {
+    LockGuard guard(&_membership_lock);
+    size_t slot = membership->client_slot;
+    if (slot != _memberships.size() - 1) {
+        _memberships[slot] = _memberships.back();
+        _memberships[slot]->client_slot = slot;
     }
+    _memberships.pop_back();
 }
 
-// Vérifier si le client est dans un channel spécifique
-bool Client::isInChannel(const std::string& channel) const {
-    return std::find(_channels.begin(), _channels.end(), channel) != _channels.end();
+// Le channel reste valide jusqu'à la fin de l'itération même si un autre shard
+// détache ce lien entre-temps: l'appelant revérifie l'appartenance sous son verrou
+Channel* Client::nextChannel() {
+    LockGuard guard(&_membership_lock);
+    return _memberships.empty() ? NULL : _memberships.back()->channel;
 }
 
 // Vérifier l'état d'enregistrement (NICK + USER complets)
@@ -150,17 +93,17 @@ void Client::_updateRegistrationStatus() {
     
     // Si le statut a changé, mettre à jour l'authentification complète
     if (_registered && !was_registered) {
-        std::cout << "Client " << _fd << " is now registered (nick: " 
-                  << _nickname << ", user: " << _username << ")" << std::endl;
+        LOG_INFO(LOG_CLIENT, "Client " << _fd << " is now registered (nick: " 
+                  << _nickname << ", user: " << _username << ")");
         
         // Si aussi le password est OK, alors complètement authentifié
         if (_password_ok) {
-            _authenticated = true;
-            std::cout << "Client " << _nickname << " is now fully authenticated" << std::endl;
+            __atomic_store_n(&_authenticated, true, __ATOMIC_RELEASE);
+            LOG_INFO(LOG_CLIENT, "Client " << _nickname << " is now fully authenticated");
         }
     } else if (_registered && _password_ok && !_authenticated) {
         // Cas où le password était déjà OK avant l'enregistrement
-        _authenticated = true;
-        std::cout << "Client " << _nickname << " is now fully authenticated" << std::endl;
+        __atomic_store_n(&_authenticated, true, __ATOMIC_RELEASE);
+        LOG_INFO(LOG_CLIENT, "Client " << _nickname << " is now fully authenticated");
     }
-} 
\ No newline at end of file
+} 
\ No newline at end of file
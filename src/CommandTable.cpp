@@ -0,0 +1,93 @@
+#include "CommandTable.hpp"
+#include "commands/AuthCommands.hpp"
+#include "commands/ChannelCommands.hpp"
+#include "commands/MessageCommands.hpp"
+#include "commands/ServerCommands.hpp"
+
+// Table indexée par CommandId (même ordre que l'enum)
+static const CommandInfo g_commands[CMD_COUNT] = {
+    // id           nom        handler                          params  enregistré  coût
+    { CMD_PASS,    "PASS",    &AuthCommands::handlePass,       1,      false,      1 },
+    { CMD_NICK,    "NICK",    &AuthCommands::handleNick,       0,      false,      1 },
+    { CMD_USER,    "USER",    &AuthCommands::handleUser,       1,      false,      1 },
+    { CMD_JOIN,    "JOIN",    &ChannelCommands::handleJoin,    1,      true,       2 },
+    { CMD_PRIVMSG, "PRIVMSG", &MessageCommands::handlePrivmsg, 2,      true,       1 },
+    { CMD_KICK,    "KICK",    &ChannelCommands::handleKick,    2,      true,       2 },
+    { CMD_INVITE,  "INVITE",  &ChannelCommands::handleInvite,  2,      true,       2 },
+    { CMD_TOPIC,   "TOPIC",   &ChannelCommands::handleTopic,   1,      true,       2 },
+    { CMD_MODE,    "MODE",    &ChannelCommands::handleMode,    1,      true,       2 },
+    { CMD_PART,    "PART",    &ChannelCommands::handlePart,    1,      true,       1 },
+    { CMD_OPER,    "OPER",    &AuthCommands::handleOper,       2,      true,       2 },
+    { CMD_STATS,   "STATS",   &ServerCommands::handleStats,    0,      true,       2 },
+    { CMD_PING,    "PING",    &ServerCommands::handlePing,     1,      false,      1 },
+    { CMD_PONG,    "PONG",    &ServerCommands::handlePong,     0,      false,      0 },
+    { CMD_CHATHISTORY, "CHATHISTORY", &MessageCommands::handleChathistory, 4, true,  2 }
+};
+
+static char toUpperAscii(char c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// Comparer le nom reçu au nom (majuscules) d'une entrée, sans copie
+static bool matches(const StringRef& received, const char* name) {
+    for (size_t i = 0; i < received.length; ++i) {
+        if (toUpperAscii(received[i]) != name[i]) {
+            return false;
+        }
+    }
+    return name[received.length] == '\0';
+}
+
+// Aiguillage sur (longueur, première lettre): au plus une comparaison complète
+// (une lettre de plus départage les rares collisions)
+const CommandInfo* CommandTable::lookup(const StringRef& command) {
+    if (command.empty()) {
+        return NULL;
+    }
+    const CommandInfo* candidate = NULL;
+    char first = toUpperAscii(command[0]);
+
+    switch (command.length) {
+        case 4:
+            switch (first) {
+                case 'P':
+                    // PASS / PART / PING / PONG: départager sur la deuxième puis la dernière lettre
+                    switch (toUpperAscii(command[1])) {
+                        case 'I': candidate = &g_commands[CMD_PING]; break;
+                        case 'O': candidate = &g_commands[CMD_PONG]; break;
+                        default:
+                            candidate = (toUpperAscii(command[3]) == 'S') ? &g_commands[CMD_PASS] : &g_commands[CMD_PART];
+                    }
+                    break;
+                case 'N': candidate = &g_commands[CMD_NICK]; break;
+                case 'U': candidate = &g_commands[CMD_USER]; break;
+                case 'J': candidate = &g_commands[CMD_JOIN]; break;
+                case 'K': candidate = &g_commands[CMD_KICK]; break;
+                case 'M': candidate = &g_commands[CMD_MODE]; break;
+                case 'O': candidate = &g_commands[CMD_OPER]; break;
+            }
+            break;
+        case 5:
+            if (first == 'T') candidate = &g_commands[CMD_TOPIC];
+            else if (first == 'S') candidate = &g_commands[CMD_STATS];
+            break;
+        case 6:
+            if (first == 'I') candidate = &g_commands[CMD_INVITE];
+            break;
+        case 7:
+            if (first == 'P') candidate = &g_commands[CMD_PRIVMSG];
+            break;
+        case 11:
+            if (first == 'C') candidate = &g_commands[CMD_CHATHISTORY];
+            break;
+    }
+
+    if (candidate != NULL && matches(command, candidate->name)) {
+        return candidate;
+    }
+    return NULL;
+}
+
+const CommandInfo& CommandTable::get(CommandId id) {
+    return g_commands[id];
+}
@@ -0,0 +1,71 @@
+#include "EpollEngine.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+#define EPOLL_MAX_EVENTS 256
+
+EpollEngine::EpollEngine() : _epoll_fd(-1), _ready(EPOLL_MAX_EVENTS) {
+    _epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epoll_fd < 0) {
+        throw std::runtime_error("epoll_create1() failed: " + std::string(strerror(errno)));
+    }
+}
+
+EpollEngine::~EpollEngine() {
+    if (_epoll_fd != -1) {
+        close(_epoll_fd);
+    }
+}
+
+// Traduire les intérêts génériques en masque epoll (toujours edge-triggered)
+unsigned int EpollEngine::_toEpoll(int interest) {
+    unsigned int mask = EPOLLET | EPOLLRDHUP;
+    if (interest & EVENT_READ)  mask |= EPOLLIN;
+    if (interest & EVENT_WRITE) mask |= EPOLLOUT;
+    return mask;
+}
+
+bool EpollEngine::add(int fd, int interest, void* data) {
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = _toEpoll(interest);
+    ev.data.ptr = data;
+    return epoll_ctl(_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+bool EpollEngine::modify(int fd, int interest, void* data) {
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = _toEpoll(interest);
+    ev.data.ptr = data;
+    return epoll_ctl(_epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+
+void EpollEngine::remove(int fd) {
+    struct epoll_event ev;  // Ignoré, mais requis par les noyaux < 2.6.9
+    std::memset(&ev, 0, sizeof(ev));
+    epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+}
+
+// epoll_wait() ne renvoie que les fds prêts
+int EpollEngine::wait(std::vector<IoEvent>& events, int timeout_ms) {
+    events.clear();
+
+    int count = epoll_wait(_epoll_fd, &_ready[0], static_cast<int>(_ready.size()), timeout_ms);
+    if (count <= 0) {
+        return count;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        IoEvent ev;
+        ev.data = _ready[i].data.ptr;
+        ev.events = 0;
+        if (_ready[i].events & (EPOLLIN | EPOLLRDHUP))  ev.events |= EVENT_READ;
+        if (_ready[i].events & EPOLLOUT)                ev.events |= EVENT_WRITE;
+        if (_ready[i].events & (EPOLLERR | EPOLLHUP))   ev.events |= EVENT_ERROR;
+        events.push_back(ev);
+    }
+    return count;
+}
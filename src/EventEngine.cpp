@@ -0,0 +1,61 @@
+#include "EventEngine.hpp"
+#include "PollEngine.hpp"
+#include "EpollEngine.hpp"
+#include "IoUringEngine.hpp"
+#include "Logger.hpp"
+#include <exception>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+// Créer le moteur demandé, avec repli automatique sur epoll puis poll()
+EventEngine* EventEngine::create(const std::string& name) {
+    if (name == "io_uring") {
+        try {
+            return new IoUringEngine();
+        } catch (const std::exception& e) {
+            LOG_WARN(LOG_SERVER, "io_uring unavailable (" << e.what() << "), falling back to epoll");
+            return create("epoll");
+        }
+    }
+    if (name == "epoll") {
+        try {
+            return new EpollEngine();
+        } catch (const std::exception& e) {
+            LOG_WARN(LOG_SERVER, "epoll unavailable (" << e.what() << "), falling back to poll");
+        }
+    } else if (name != "poll") {
+        LOG_WARN(LOG_SERVER, "Unknown event engine '" << name << "', falling back to poll");
+    }
+    return new PollEngine();
+}
+
+bool EventEngine::addListener(int fd, void* data) {
+    return add(fd, EVENT_READ, data);
+}
+
+bool EventEngine::addConnection(int fd, int interest, void* data) {
+    return add(fd, interest, data);
+}
+
+int EventEngine::accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len) {
+    return accept4(listen_fd, addr, addr_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+}
+
+ssize_t EventEngine::receive(int fd, struct iovec* iov, int iov_count) {
+    return readv(fd, iov, iov_count);
+}
+
+// Un sendmsg() par socket
+void EventEngine::sendBatch(SendRequest* requests, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(requests[i].iov);
+        msg.msg_iovlen = requests[i].iov_count;
+        do {
+            requests[i].result = sendmsg(requests[i].fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        } while (requests[i].result < 0 && errno == EINTR);
+        requests[i].error = requests[i].result < 0 ? errno : 0;
+    }
+}
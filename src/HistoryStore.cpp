@@ -0,0 +1,241 @@
+#include "HistoryStore.hpp"
+#include "LockGuard.hpp"
+#include "Metrics.hpp"
+#include "utils.hpp"  // pour realtimeMs
+
+HistoryStore::HistoryStore(const ServerConfig& config)
+    : _max_lines(config.history_lines), _max_bytes(config.history_bytes), _budget(config.history_budget),
+      _bytes(0), _evictions(0), _coldest(NULL), _hottest(NULL), _oldest_tombstone(NULL), _newest_tombstone(NULL) {
+    pthread_mutex_init(&_lock, NULL);
+}
+
+HistoryStore::~HistoryStore() {
+    std::vector<HistoryTombstone*> tombstones;
+    _tombstones.values(tombstones);
+    for (size_t i = 0; i < tombstones.size(); ++i) {
+        delete tombstones[i];
+    }
+    pthread_mutex_destroy(&_lock);
+}
+
+void HistoryStore::_link(ChannelHistory& history) {
+    history._colder = _hottest;
+    history._warmer = NULL;
+    if (_hottest != NULL) {
+        _hottest->_warmer = &history;
+    } else {
+        _coldest = &history;
+    }
+    _hottest = &history;
+    history._linked = true;
+}
+
+void HistoryStore::_unlink(ChannelHistory& history) {
+    if (!history._linked) {
+        return;
+    }
+    if (history._colder != NULL) {
+        history._colder->_warmer = history._warmer;
+    } else {
+        _coldest = history._warmer;
+    }
+    if (history._warmer != NULL) {
+        history._warmer->_colder = history._colder;
+    } else {
+        _hottest = history._colder;
+    }
+    history._colder = NULL;
+    history._warmer = NULL;
+    history._linked = false;
+}
+
+// to (vide, hors liste) reprend les entrées de from et sa place dans la liste froid -> chaud
+void HistoryStore::_move(ChannelHistory& from, ChannelHistory& to) {
+    to._swapContents(from);
+    to._colder = from._colder;
+    to._warmer = from._warmer;
+    to._linked = from._linked;
+    if (to._linked) {
+        if (to._colder != NULL) {
+            to._colder->_warmer = &to;
+        } else {
+            _coldest = &to;
+        }
+        if (to._warmer != NULL) {
+            to._warmer->_colder = &to;
+        } else {
+            _hottest = &to;
+        }
+    }
+    from._colder = NULL;
+    from._warmer = NULL;
+    from._linked = false;
+}
+
+// Pierre tombale: objet, nom et entrée de l'index (l'anneau est compté par son historique)
+size_t HistoryStore::_tombstoneCost(const std::string& name) {
+    return sizeof(HistoryTombstone) + name.size() + CaseMap<HistoryTombstone*>::entryCost(name);
+}
+
+void HistoryStore::_bury(HistoryTombstone* tombstone) {
+    tombstone->older = _newest_tombstone;
+    tombstone->newer = NULL;
+    if (_newest_tombstone != NULL) {
+        _newest_tombstone->newer = tombstone;
+    } else {
+        _oldest_tombstone = tombstone;
+    }
+    _newest_tombstone = tombstone;
+    metricSet(_bytes, _bytes + _tombstoneCost(tombstone->name));
+}
+
+void HistoryStore::_unbury(HistoryTombstone* tombstone) {
+    if (tombstone->older != NULL) {
+        tombstone->older->newer = tombstone->newer;
+    } else {
+        _oldest_tombstone = tombstone->newer;
+    }
+    if (tombstone->newer != NULL) {
+        tombstone->newer->older = tombstone->older;
+    } else {
+        _newest_tombstone = tombstone->older;
+    }
+    _tombstones.erase(tombstone->name);
+    metricSet(_bytes, _bytes - _tombstoneCost(tombstone->name));
+    delete tombstone;
+}
+
+// Retirer le plus vieux message; un historique vidé rend aussi son anneau
+// (et disparaît s'il appartenait à un channel détruit)
+void HistoryStore::_dropOldest(ChannelHistory& history) {
+    metricSet(_bytes, _bytes - history._popOldest());
+    if (history.empty()) {
+        _unlink(history);
+        metricSet(_bytes, _bytes - history._clear());
+        if (history._tombstone != NULL) {
+            _unbury(history._tombstone);
+        }
+    }
+}
+
+// Au-delà du budget, vider les historiques les plus froids (y compris les pierres tombales)
+void HistoryStore::_enforceBudget() {
+    while (_bytes > _budget && _coldest != NULL) {
+        _dropOldest(*_coldest);
+        metricAdd(_evictions, 1);
+    }
+}
+
+// Ajouter une ligne: d'abord les bornes du channel, puis le budget global
+void HistoryStore::record(ChannelHistory& history, const SharedBuffer& line) {
+    if (_max_lines == 0) {
+        return;
+    }
+    LockGuard guard(&_lock);
+    HistoryEntry entry;
+    entry.line = line;
+    entry.time_ms = realtimeMs();
+    if (!history.empty() && entry.time_ms < history.at(history.size() - 1).time_ms) {
+        entry.time_ms = history.at(history.size() - 1).time_ms; // Horloge reculée: garder l'ordre
+    }
+
+    // Le coût baisse quand on libère une case: l'anneau n'a alors plus à grandir
+    while (!history.empty() &&
+           (history.size() >= _max_lines || history.bytes() + history.pushCost(entry, _max_lines) > _max_bytes)) {
+        _dropOldest(history);
+    }
+    metricSet(_bytes, _bytes + history._push(entry, _max_lines));
+
+    // Devenu le plus chaud
+    _unlink(history);
+    _link(history);
+    _enforceBudget();
+}
+
+void HistoryStore::_release(ChannelHistory& history) {
+    _unlink(history);
+    metricSet(_bytes, _bytes - history._clear());
+}
+
+void HistoryStore::release(ChannelHistory& history) {
+    LockGuard guard(&_lock);
+    _release(history);
+}
+
+// Le channel est détruit: son historique passe dans une pierre tombale, sans copie des lignes
+// Au-delà de HISTORY_MAX_TOMBSTONES, la plus ancienne est oubliée avec ses messages.
+void HistoryStore::retire(const std::string& name, ChannelHistory& history) {
+    LockGuard guard(&_lock);
+    if (history.empty()) {
+        _release(history);
+        return;
+    }
+    HistoryTombstone* tombstone = new HistoryTombstone;
+    tombstone->name = name;
+    tombstone->history._tombstone = tombstone;
+    if (!_tombstones.insert(name, tombstone)) {
+        delete tombstone;               // Impossible: restore() retire la précédente
+        _release(history);
+        return;
+    }
+    _move(history, tombstone->history);
+    history._clear();
+    _bury(tombstone);
+
+    while (_tombstones.size() > HISTORY_MAX_TOMBSTONES) {
+        HistoryTombstone* oldest = _oldest_tombstone;
+        metricAdd(_evictions, oldest->history.size());
+        _release(oldest->history);
+        _unbury(oldest);
+    }
+    _enforceBudget();
+}
+
+// Un channel de ce nom est créé: reprendre l'historique gardé, s'il n'a pas été évincé
+void HistoryStore::restore(const StringRef& name, ChannelHistory& history) {
+    LockGuard guard(&_lock);
+    HistoryTombstone** found = _tombstones.find(name);
+    if (found == NULL) {
+        return;
+    }
+    HistoryTombstone* tombstone = *found;
+    _move(tombstone->history, history);
+    _unbury(tombstone);
+}
+
+// Les lignes copiées partagent les blocs de l'historique: à envoyer après avoir relâché les verrous
+void HistoryStore::select(const ChannelHistory& history, HistoryQuery query, long long time_ms, size_t limit,
+                          std::vector<SharedBuffer>& out) {
+    LockGuard guard(&_lock);
+    
+    // Fenêtre [start, end) dans l'historique
+    size_t start = 0;
+    size_t end = history.size();
+    switch (query) {
+        case HISTORY_LATEST_ALL:
+        case HISTORY_LATEST:
+            start = query == HISTORY_LATEST ? history.upperBound(time_ms) : 0;
+            start = end - start > limit ? end - limit : start;
+            break;
+        case HISTORY_BEFORE:
+            end = history.lowerBound(time_ms);
+            start = end > limit ? end - limit : 0;
+            break;
+        case HISTORY_AFTER:
+            start = history.upperBound(time_ms);
+            end = end - start > limit ? start + limit : end;
+            break;
+    }
+    
+    for (size_t i = start; i < end; ++i) {
+        out.push_back(history.at(i).line);
+    }
+}
+
+unsigned long HistoryStore::bytes() const {
+    return metricRead(_bytes);
+}
+
+unsigned long HistoryStore::evictions() const {
+    return metricRead(_evictions);
+}
@@ -0,0 +1,787 @@
+#include "IoUringEngine.hpp"
+#include "Logger.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+
+#define URING_OPERATION_MASK 7ULL
+#define URING_SEND_INDEX_MASK 0x1FFFFFFFULL // Bits 3 à 31 du user_data d'un envoi
+#define URING_MAX_HELD_CHUNKS 2             // Buffers gardés par un client qui ne lit plus: au-delà, recv annulé
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void* arg, size_t arg_size) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+IoUringEngine::IoUringEngine()
+    : _ring_fd(-1), _features(0), _sq_ring(NULL), _sq_ring_size(0), _cq_ring(NULL), _cq_ring_size(0),
+      _sqes(NULL), _sqes_size(0), _sq_head(NULL), _sq_tail(NULL), _sq_array(NULL), _sq_mask(0), _sq_entries(0),
+      _sq_local_tail(0), _cq_head(NULL), _cq_tail(NULL), _cq_mask(0), _cqes(NULL),
+      _batch(NULL), _batch_remaining(0), _batch_generation(0) {
+    try {
+        _setupRing();
+        _checkSupport();
+        _addBufferGroup();
+    } catch (...) {
+        _release();
+        throw;
+    }
+}
+
+IoUringEngine::~IoUringEngine() {
+    _release();
+}
+
+// Fermer l'anneau (le noyau annule tout ce qui est en vol) puis libérer la mémoire
+void IoUringEngine::_release() {
+    for (size_t fd = 0; fd < _fds.size(); ++fd) {
+        if (_fds[fd] != NULL) {
+            _dropData(_fds[fd]);
+            delete _fds[fd];
+        }
+    }
+    _fds.clear();
+    for (size_t i = 0; i < _detached.size(); ++i) {
+        delete _detached[i];
+    }
+    _detached.clear();
+
+    if (_ring_fd != -1) {
+        close(_ring_fd);
+        _ring_fd = -1;
+    }
+    // Zones mmap(): une écriture tardive du noyau échouerait au lieu de corrompre le tas
+    for (size_t i = 0; i < _groups.size(); ++i) {
+        _freeBufferGroup(_groups[i]);
+    }
+    _groups.clear();
+    if (_sqes != NULL) {
+        munmap(_sqes, _sqes_size);
+        _sqes = NULL;
+    }
+    if (_cq_ring != NULL && _cq_ring != _sq_ring) {
+        munmap(_cq_ring, _cq_ring_size);
+    }
+    _cq_ring = NULL;
+    if (_sq_ring != NULL) {
+        munmap(_sq_ring, _sq_ring_size);
+        _sq_ring = NULL;
+    }
+}
+
+// Créer l'anneau et projeter les files de soumission / complétion
+void IoUringEngine::_setupRing() {
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    params.cq_entries = URING_CQ_ENTRIES;
+
+    _ring_fd = ioUringSetup(URING_SQ_ENTRIES, &params);
+    if (_ring_fd < 0) {
+        throw std::runtime_error("io_uring_setup() failed: " + std::string(strerror(errno)));
+    }
+    _features = params.features;
+    if (!(_features & IORING_FEAT_NODROP) || !(_features & IORING_FEAT_EXT_ARG)) {
+        throw std::runtime_error("io_uring features missing (kernel too old)");
+    }
+
+    _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (_features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && _cq_ring_size > _sq_ring_size) {
+        _sq_ring_size = _cq_ring_size;
+    }
+
+    void* sq_ring = mmap(NULL, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         _ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) {
+        throw std::runtime_error("io_uring mmap failed: " + std::string(strerror(errno)));
+    }
+    _sq_ring = sq_ring;
+    if (single_mmap) {
+        _cq_ring = _sq_ring;
+    } else {
+        void* cq_ring = mmap(NULL, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             _ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) {
+            throw std::runtime_error("io_uring mmap failed: " + std::string(strerror(errno)));
+        }
+        _cq_ring = cq_ring;
+    }
+    _sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      _ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        throw std::runtime_error("io_uring mmap failed: " + std::string(strerror(errno)));
+    }
+    _sqes = static_cast<struct io_uring_sqe*>(sqes);
+
+    char* sq = static_cast<char*>(_sq_ring);
+    _sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    _sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    _sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    _sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    _sq_entries = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    _sq_local_tail = *_sq_tail;
+
+    char* cq = static_cast<char*>(_cq_ring);
+    _cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    _cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    _cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+// Opérations requises, et noyau >= 6.0 pour le recv multishot (non signalé par la sonde)
+void IoUringEngine::_checkSupport() {
+    struct utsname name;
+    int major = 0;
+    int minor = 0;
+    if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2 || major < 6) {
+        throw std::runtime_error("multishot recv requires Linux 6.0");
+    }
+
+    size_t size = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe* probe = static_cast<struct io_uring_probe*>(std::calloc(1, size));
+    if (probe == NULL) {
+        throw std::bad_alloc();
+    }
+    static const int required[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG,
+                                    IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL };
+    bool supported = ioUringRegister(_ring_fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    for (size_t i = 0; supported && i < sizeof(required) / sizeof(required[0]); ++i) {
+        supported = required[i] <= probe->last_op && (probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED);
+    }
+    std::free(probe);
+    if (!supported) {
+        throw std::runtime_error("required io_uring operations not supported");
+    }
+}
+
+// Anneau de buffers fournis: le noyau y choisit où écrire chaque recv
+// Enregistré sous le bgid suivant; un échec ne laisse aucun groupe à moitié créé.
+IoUringEngine::BufferGroup* IoUringEngine::_addBufferGroup() {
+    BufferGroup* group = new BufferGroup;
+    group->id = static_cast<unsigned short>(_groups.size());
+    group->ring_size = URING_BUFFER_COUNT * sizeof(struct io_uring_buf);
+    group->ring = NULL;
+    group->buffers = NULL;
+    group->tail = 0;
+    group->connections = 0;
+    try {
+        void* ring = mmap(NULL, group->ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ring == MAP_FAILED) {
+            throw std::runtime_error("buffer ring mmap failed: " + std::string(strerror(errno)));
+        }
+        group->ring = static_cast<struct io_uring_buf_ring*>(ring);
+        void* buffers = mmap(NULL, URING_BUFFER_COUNT * URING_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (buffers == MAP_FAILED) {
+            throw std::runtime_error("receive buffers mmap failed: " + std::string(strerror(errno)));
+        }
+        group->buffers = static_cast<char*>(buffers);
+
+        struct io_uring_buf_reg reg;
+        std::memset(&reg, 0, sizeof(reg));
+        reg.ring_addr = reinterpret_cast<unsigned long>(group->ring);
+        reg.ring_entries = URING_BUFFER_COUNT;
+        reg.bgid = group->id;
+        if (ioUringRegister(_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            throw std::runtime_error("buffer ring registration failed: " + std::string(strerror(errno)));
+        }
+    } catch (...) {
+        _freeBufferGroup(group);
+        throw;
+    }
+    _groups.push_back(group);
+    for (unsigned short id = 0; id < URING_BUFFER_COUNT; ++id) {
+        _recycleBuffer(group, id);
+    }
+    return group;
+}
+
+// Un anneau sert au plus URING_GROUP_CONNECTIONS connexions: même si chacune garde
+// URING_MAX_HELD_CHUNKS buffers (lecture suspendue, fake lag), il en reste pour les autres.
+IoUringEngine::BufferGroup* IoUringEngine::_pickBufferGroup() {
+    BufferGroup* group = _groups[0];
+    for (size_t i = 1; i < _groups.size(); ++i) {
+        if (_groups[i]->connections < group->connections) {
+            group = _groups[i];
+        }
+    }
+    if (group->connections >= URING_GROUP_CONNECTIONS && _groups.size() < URING_MAX_BUFFER_GROUPS) {
+        try {
+            group = _addBufferGroup();
+        } catch (const std::exception& e) {
+            LOG_WARN(LOG_NET, "io_uring buffer ring not added (" << e.what() << "), sharing an existing one");
+        }
+    }
+    return group;
+}
+
+void IoUringEngine::_freeBufferGroup(BufferGroup* group) {
+    if (group->buffers != NULL) {
+        munmap(group->buffers, URING_BUFFER_COUNT * URING_BUFFER_SIZE);
+    }
+    if (group->ring != NULL) {
+        munmap(group->ring, group->ring_size);
+    }
+    delete group;
+}
+
+// Rendre un buffer au noyau (publié immédiatement)
+// Entrées indexées depuis le début de l'anneau: en C++, le membre bufs est décalé par
+// __DECLARE_FLEX_ARRAY. Champ par champ: la queue partage la première entrée.
+void IoUringEngine::_recycleBuffer(BufferGroup* group, unsigned short buffer_id) {
+    struct io_uring_buf* buf = reinterpret_cast<struct io_uring_buf*>(group->ring) + (group->tail & (URING_BUFFER_COUNT - 1));
+    buf->addr = reinterpret_cast<unsigned long>(group->buffers + buffer_id * URING_BUFFER_SIZE);
+    buf->len = URING_BUFFER_SIZE;
+    buf->bid = buffer_id;
+    ++group->tail;
+    __atomic_store_n(&group->ring->tail, group->tail, __ATOMIC_RELEASE);
+
+    // Des recv de ce groupe se sont arrêtés faute de buffer: les relancer
+    for (size_t i = 0; i < group->starved.size(); ++i) {
+        group->starved[i]->starved = false;
+        _queueRearm(group->starved[i]);
+    }
+    group->starved.clear();
+}
+
+unsigned long long IoUringEngine::_userData(FdState* state, Operation operation) {
+    return reinterpret_cast<unsigned long long>(state) | operation;
+}
+
+// Entrée libre de la file de soumission (soumet d'abord si elle est pleine)
+struct io_uring_sqe* IoUringEngine::_getSqe() {
+    while (_sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE) >= _sq_entries) {
+        if (_enter(_sq_local_tail - *_sq_head, 0, 0, -1) < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+            throw std::runtime_error("io_uring_enter() failed: " + std::string(strerror(errno)));
+        }
+    }
+    unsigned index = _sq_local_tail & _sq_mask;
+    struct io_uring_sqe* sqe = &_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    _sq_array[index] = index;
+    ++_sq_local_tail;
+    return sqe;
+}
+
+void IoUringEngine::_publish() {
+    __atomic_store_n(_sq_tail, _sq_local_tail, __ATOMIC_RELEASE);
+}
+
+// Soumettre et/ou attendre (timeout_ms = -1: sans limite)
+int IoUringEngine::_enter(unsigned to_submit, unsigned min_complete, unsigned flags, int timeout_ms) {
+    _publish();
+    if (timeout_ms >= 0 && (flags & IORING_ENTER_GETEVENTS)) {
+        struct __kernel_timespec ts;
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+        struct io_uring_getevents_arg arg;
+        std::memset(&arg, 0, sizeof(arg));
+        arg.ts = reinterpret_cast<unsigned long>(&ts);
+        return ioUringEnter(_ring_fd, to_submit, min_complete, flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    }
+    return ioUringEnter(_ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+// Consommer toutes les complétions postées
+void IoUringEngine::_reapCompletions() {
+    unsigned head = *_cq_head;
+    while (true) {
+        unsigned tail = __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            break;
+        }
+        while (head != tail) {
+            struct io_uring_cqe cqe = _cqes[head & _cq_mask];
+            ++head;
+            _complete(cqe);
+        }
+        __atomic_store_n(_cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+void IoUringEngine::_complete(const struct io_uring_cqe& cqe) {
+    Operation operation = static_cast<Operation>(cqe.user_data & URING_OPERATION_MASK);
+    if (operation == OP_NONE) {
+        return;
+    }
+    if (operation == OP_SEND) {
+        size_t index = static_cast<size_t>((cqe.user_data >> 3) & URING_SEND_INDEX_MASK);
+        if (_batch == NULL || (cqe.user_data >> 32) != _batch_generation || index >= _batch_msgs.size()) {
+            return; // Lot abandonné après une erreur fatale de l'anneau
+        }
+        SendRequest& request = _batch[index];
+        request.result = cqe.res < 0 ? -1 : cqe.res;
+        request.error = cqe.res < 0 ? -cqe.res : 0;
+        --_batch_remaining;
+        return;
+    }
+
+    FdState* state = reinterpret_cast<FdState*>(cqe.user_data & ~URING_OPERATION_MASK);
+    if (operation == OP_POLLOUT) {
+        state->pollout = false;
+        if (state->interest & EVENT_WRITE) {
+            bool failed = cqe.res < 0 || (cqe.res & (POLLERR | POLLHUP));
+            _queueReady(state, EVENT_WRITE | (failed ? EVENT_ERROR : 0));
+            _queueRearm(state); // Réarmé tant que l'intérêt garde EVENT_WRITE
+        }
+        _finish(state);
+        return;
+    }
+    _completeMultishot(state, cqe);
+}
+
+// Une complétion d'accept / recv / poll multishot
+// Sans IORING_CQE_F_MORE, l'opération est terminée: elle sera réarmée si besoin.
+void IoUringEngine::_completeMultishot(FdState* state, const struct io_uring_cqe& cqe) {
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    if (state->kind == FD_LISTENER) {
+        if (cqe.res >= 0) {
+            if (state->closed) {
+                close(cqe.res);
+            } else {
+                state->accepted.push_back(cqe.res);
+                _queueReady(state, EVENT_READ);
+            }
+        } else if (!more && (cqe.res == -EMFILE || cqe.res == -ENFILE || cqe.res == -ENOMEM || cqe.res == -ENOBUFS)) {
+            state->starved = true; // Relancé au prochain remove(), quand un fd se libère
+            _starved_listeners.push_back(state);
+        }
+    } else if (state->kind == FD_CONNECTION) {
+        if (cqe.flags & IORING_CQE_F_BUFFER) {
+            unsigned short buffer_id = static_cast<unsigned short>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+            if (cqe.res > 0 && !state->closed) {
+                Chunk chunk;
+                chunk.buffer_id = buffer_id;
+                chunk.length = cqe.res;
+                chunk.offset = 0;
+                state->chunks.push_back(chunk);
+                _queueReady(state, EVENT_READ);
+                if (state->chunks.size() >= URING_MAX_HELD_CHUNKS && more && !state->cancelling) {
+                    _cancel(state, OP_MULTISHOT);
+                }
+            } else {
+                _recycleBuffer(state->group, buffer_id);
+            }
+        }
+        if (!state->closed && cqe.res <= 0 && cqe.res != -ECANCELED) {
+            if (cqe.res == -ENOBUFS) {
+                state->starved = true;
+                state->group->starved.push_back(state);
+            } else {
+                state->end_error = -cqe.res; // 0: fin de connexion
+                _queueReady(state, EVENT_READ);
+            }
+        }
+    } else if (cqe.res != -ECANCELED) {
+        int events = 0;
+        if (cqe.res < 0 || (cqe.res & (POLLERR | POLLHUP))) events |= EVENT_ERROR;
+        if (cqe.res > 0 && (cqe.res & (POLLIN | POLLRDHUP))) events |= EVENT_READ;
+        if (cqe.res > 0 && (cqe.res & POLLOUT))              events |= EVENT_WRITE;
+        _queueReady(state, events);
+    }
+
+    if (!more) {
+        state->multishot = false;
+        state->cancelling = false;
+        _queueRearm(state);
+        _finish(state);
+    }
+}
+
+void IoUringEngine::_finish(FdState* state) {
+    --state->inflight;
+}
+
+void IoUringEngine::_queueReady(FdState* state, int events) {
+    if (state->closed || events == 0) {
+        return;
+    }
+    if (state->pending == 0) {
+        _ready.push_back(state);
+    }
+    state->pending |= events;
+}
+
+void IoUringEngine::_queueRearm(FdState* state) {
+    if (state->closed || state->queued) {
+        return;
+    }
+    state->queued = true;
+    _rearm.push_back(state);
+}
+
+void IoUringEngine::_armPending() {
+    for (size_t i = 0; i < _rearm.size(); ++i) {
+        _arm(_rearm[i]);
+    }
+    _rearm.clear();
+}
+
+// Mettre les opérations d'un fd en accord avec son intérêt courant
+void IoUringEngine::_arm(FdState* state) {
+    state->queued = false;
+    if (state->closed) {
+        return;
+    }
+    bool wants_read = (state->interest & EVENT_READ) != 0;
+
+    if (state->kind == FD_CONNECTION) {
+        if (wants_read && !state->multishot && !state->starved && state->end_error < 0 &&
+            state->chunks.size() < URING_MAX_HELD_CHUNKS) {
+            struct io_uring_sqe* sqe = _getSqe();
+            sqe->opcode = IORING_OP_RECV;
+            sqe->fd = state->fd;
+            sqe->ioprio = IORING_RECV_MULTISHOT;
+            sqe->flags = IOSQE_BUFFER_SELECT;
+            sqe->buf_group = state->group->id;
+            sqe->user_data = _userData(state, OP_MULTISHOT);
+            state->multishot = true;
+            ++state->inflight;
+        } else if (!wants_read && state->multishot && !state->cancelling) {
+            _cancel(state, OP_MULTISHOT);
+        }
+        if ((state->interest & EVENT_WRITE) && !state->pollout) {
+            struct io_uring_sqe* sqe = _getSqe();
+            sqe->opcode = IORING_OP_POLL_ADD;
+            sqe->fd = state->fd;
+            sqe->poll32_events = POLLOUT;
+            sqe->user_data = _userData(state, OP_POLLOUT);
+            state->pollout = true;
+            ++state->inflight;
+        }
+        return;
+    }
+    if (state->multishot || state->starved || state->interest == 0 || (state->kind == FD_LISTENER && !wants_read)) {
+        return;
+    }
+
+    struct io_uring_sqe* sqe = _getSqe();
+    sqe->fd = state->fd;
+    sqe->user_data = _userData(state, OP_MULTISHOT);
+    if (state->kind == FD_LISTENER) {
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    } else {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->len = IORING_POLL_ADD_MULTI;
+        sqe->poll32_events = ((state->interest & EVENT_READ) ? POLLIN | POLLRDHUP : 0) |
+                             ((state->interest & EVENT_WRITE) ? POLLOUT : 0);
+    }
+    state->multishot = true;
+    ++state->inflight;
+}
+
+// Annuler une opération en vol; sa complétion finale (-ECANCELED) arrivera ensuite
+void IoUringEngine::_cancel(FdState* state, Operation operation) {
+    struct io_uring_sqe* sqe = _getSqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = _userData(state, operation);
+    sqe->user_data = _userData(NULL, OP_NONE);
+    if (operation == OP_MULTISHOT) {
+        state->cancelling = true;
+    }
+}
+
+// Rendre les buffers et fermer les connexions acceptées non reprises
+void IoUringEngine::_dropData(FdState* state) {
+    for (size_t i = 0; i < state->chunks.size(); ++i) {
+        _recycleBuffer(state->group, state->chunks[i].buffer_id);
+    }
+    state->chunks.clear();
+    for (size_t i = 0; i < state->accepted.size(); ++i) {
+        close(state->accepted[i]);
+    }
+    state->accepted.clear();
+}
+
+IoUringEngine::FdState* IoUringEngine::_register(int fd, FdKind kind, int interest, void* data) {
+    if (fd < 0) {
+        errno = EBADF;
+        return NULL;
+    }
+    if (static_cast<size_t>(fd) >= _fds.size()) {
+        _fds.resize(fd + 1, static_cast<FdState*>(NULL));
+    }
+    if (_fds[fd] != NULL) {
+        errno = EEXIST;
+        return NULL;
+    }
+    FdState* state = new FdState;
+    state->fd = fd;
+    state->kind = kind;
+    state->interest = interest;
+    state->data = data;
+    state->closed = false;
+    state->inflight = 0;
+    state->multishot = false;
+    state->cancelling = false;
+    state->pollout = false;
+    state->starved = false;
+    state->end_error = -1;
+    state->pending = 0;
+    state->queued = false;
+    state->group = NULL;
+    if (kind == FD_CONNECTION) {
+        state->group = _pickBufferGroup();
+        ++state->group->connections;
+    }
+    _fds[fd] = state;
+    _queueRearm(state);
+    return state;
+}
+
+// Les opérations partent avec la prochaine soumission (wait ou sendBatch)
+bool IoUringEngine::add(int fd, int interest, void* data) {
+    return _register(fd, FD_GENERIC, interest, data) != NULL;
+}
+
+bool IoUringEngine::addListener(int fd, void* data) {
+    return _register(fd, FD_LISTENER, EVENT_READ, data) != NULL;
+}
+
+bool IoUringEngine::addConnection(int fd, int interest, void* data) {
+    return _register(fd, FD_CONNECTION, interest, data) != NULL;
+}
+
+// Comme EPOLL_CTL_MOD, ce qui est déjà disponible est signalé de nouveau
+bool IoUringEngine::modify(int fd, int interest, void* data) {
+    FdState* state = (fd >= 0 && static_cast<size_t>(fd) < _fds.size()) ? _fds[fd] : NULL;
+    if (state == NULL) {
+        errno = ENOENT;
+        return false;
+    }
+    int added = interest & ~state->interest;
+    state->interest = interest;
+    state->data = data;
+    if (state->kind == FD_GENERIC && state->multishot && !state->cancelling) {
+        _cancel(state, OP_MULTISHOT); // Nouveau masque: réarmé après la complétion finale
+    }
+    if ((added & EVENT_READ) && (!state->chunks.empty() || !state->accepted.empty() || state->end_error >= 0)) {
+        _queueReady(state, EVENT_READ);
+    }
+    _queueRearm(state);
+    return true;
+}
+
+// L'état reste détaché jusqu'à la complétion finale de ses opérations annulées
+void IoUringEngine::remove(int fd) {
+    FdState* state = (fd >= 0 && static_cast<size_t>(fd) < _fds.size()) ? _fds[fd] : NULL;
+    if (state == NULL) {
+        return;
+    }
+    _fds[fd] = NULL;
+    state->closed = true;
+    _dropData(state);
+    if (state->group != NULL) {
+        --state->group->connections;
+    }
+    if (state->starved) {
+        std::vector<FdState*>& starved = state->kind == FD_LISTENER ? _starved_listeners : state->group->starved;
+        for (size_t i = 0; i < starved.size(); ++i) {
+            if (starved[i] == state) {
+                starved[i] = starved.back();
+                starved.pop_back();
+                break;
+            }
+        }
+    }
+    if (state->multishot && !state->cancelling) {
+        _cancel(state, OP_MULTISHOT);
+    }
+    if (state->pollout) {
+        _cancel(state, OP_POLLOUT);
+    }
+    _detached.push_back(state);
+
+    // Un fd vient de se libérer: relancer les accept arrêtés (EMFILE...)
+    for (size_t i = 0; i < _starved_listeners.size(); ++i) {
+        _starved_listeners[i]->starved = false;
+        _queueRearm(_starved_listeners[i]);
+    }
+    _starved_listeners.clear();
+}
+
+int IoUringEngine::wait(std::vector<IoEvent>& events, int timeout_ms) {
+    events.clear();
+    _armPending();
+    _reapCompletions();
+
+    // Des événements sont déjà prêts (modify(), lots d'envois): ne pas attendre
+    int timeout = _ready.empty() ? timeout_ms : 0;
+    unsigned to_submit = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+    int ret = _enter(to_submit, timeout != 0 ? 1 : 0, IORING_ENTER_GETEVENTS, timeout);
+    if (ret < 0 && errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+        return -1;
+    }
+    bool interrupted = (ret < 0 && errno == EINTR);
+    _reapCompletions();
+
+    for (size_t i = 0; i < _ready.size(); ++i) {
+        FdState* state = _ready[i];
+        if (!state->closed && state->pending != 0) {
+            IoEvent ev;
+            ev.data = state->data;
+            ev.events = state->pending;
+            events.push_back(ev);
+        }
+        state->pending = 0;
+    }
+    _ready.clear();
+
+    // Plus aucune complétion à venir pour les fds retirés
+    size_t kept = 0;
+    for (size_t i = 0; i < _detached.size(); ++i) {
+        if (_detached[i]->inflight > 0) {
+            _detached[kept++] = _detached[i];
+        } else {
+            delete _detached[i];
+        }
+    }
+    _detached.resize(kept);
+
+    if (events.empty() && interrupted) {
+        errno = EINTR;
+        return -1;
+    }
+    return static_cast<int>(events.size());
+}
+
+// Connexion déjà acceptée par le noyau (adresse relue: l'accept multishot ne la fournit pas)
+int IoUringEngine::accept(int listen_fd, struct sockaddr* addr, socklen_t* addr_len) {
+    FdState* state = (listen_fd >= 0 && static_cast<size_t>(listen_fd) < _fds.size()) ? _fds[listen_fd] : NULL;
+    if (state == NULL || state->kind != FD_LISTENER) {
+        errno = EBADF;
+        return -1;
+    }
+    if (state->accepted.empty()) {
+        errno = EAGAIN;
+        return -1;
+    }
+    int fd = state->accepted.front();
+    state->accepted.pop_front();
+    if (addr != NULL && addr_len != NULL && getpeername(fd, addr, addr_len) < 0) {
+        std::memset(addr, 0, *addr_len);
+    }
+    return fd;
+}
+
+// Copier les données déjà reçues dans les segments de l'appelant
+// Les buffers vidés retournent aussitôt au noyau.
+ssize_t IoUringEngine::receive(int fd, struct iovec* iov, int iov_count) {
+    FdState* state = (fd >= 0 && static_cast<size_t>(fd) < _fds.size()) ? _fds[fd] : NULL;
+    if (state == NULL || state->kind != FD_CONNECTION) {
+        errno = EBADF;
+        return -1;
+    }
+    size_t copied = 0;
+    size_t iov_offset = 0;
+    int index = 0;
+    while (!state->chunks.empty() && index < iov_count) {
+        Chunk& chunk = state->chunks.front();
+        size_t length = chunk.length - chunk.offset;
+        if (length > iov[index].iov_len - iov_offset) {
+            length = iov[index].iov_len - iov_offset;
+        }
+        std::memcpy(static_cast<char*>(iov[index].iov_base) + iov_offset,
+                    state->group->buffers + chunk.buffer_id * URING_BUFFER_SIZE + chunk.offset, length);
+        copied += length;
+        chunk.offset += length;
+        iov_offset += length;
+        if (chunk.offset == chunk.length) {
+            _recycleBuffer(state->group, chunk.buffer_id);
+            state->chunks.pop_front();
+            if (state->chunks.empty()) {
+                _queueRearm(state); // Recv annulé pour trop de données gardées: le relancer
+            }
+        }
+        if (iov_offset == iov[index].iov_len) {
+            ++index;
+            iov_offset = 0;
+        }
+    }
+    if (copied > 0) {
+        return copied;
+    }
+    if (state->end_error == 0) {
+        return 0;
+    }
+    errno = state->end_error > 0 ? state->end_error : EAGAIN;
+    return -1;
+}
+
+// Tous les envois en une soumission (MSG_DONTWAIT: chacun se termine aussitôt,
+// EAGAIN compris), puis attente de leurs complétions; les autres complétions
+// reçues au passage sont gardées pour le prochain wait().
+// Le lot n'est rendu qu'une fois toutes ses complétions reçues: un résultat n'est
+// jamais deviné (un envoi supposé perdu a pu partir et corromprait le flux).
+void IoUringEngine::sendBatch(SendRequest* requests, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    _batch = requests;
+    _batch_msgs.resize(count);
+    _batch_remaining = count;
+    ++_batch_generation;
+    for (size_t i = 0; i < count; ++i) {
+        struct msghdr& msg = _batch_msgs[i];
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = const_cast<struct iovec*>(requests[i].iov);
+        msg.msg_iovlen = requests[i].iov_count;
+        requests[i].result = -1;
+        requests[i].error = EINPROGRESS; // Sans complétion pour l'instant
+
+        struct io_uring_sqe* sqe = _getSqe();
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->fd = requests[i].fd;
+        sqe->addr = reinterpret_cast<unsigned long>(&msg);
+        sqe->len = 1;
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+        sqe->user_data = (static_cast<unsigned long long>(_batch_generation) << 32) |
+                         (static_cast<unsigned long long>(i) << 3) | OP_SEND;
+    }
+    while (_batch_remaining > 0) {
+        unsigned to_submit = _sq_local_tail - __atomic_load_n(_sq_head, __ATOMIC_ACQUIRE);
+        if (_enter(to_submit, 1, IORING_ENTER_GETEVENTS, -1) < 0 &&
+            errno != EINTR && errno != EBUSY && errno != EAGAIN) {
+            _abortBatch(errno);
+            break;
+        }
+        _reapCompletions();
+    }
+    _batch = NULL;
+}
+
+// Anneau inutilisable: le sort des envois sans complétion est inconnu
+// Leurs connexions sont fermées (ECONNABORTED: l'appelant déconnecte le client)
+// plutôt que de laisser renvoyer ou perdre des octets au milieu du flux.
+void IoUringEngine::_abortBatch(int error) {
+    LOG_ERROR(LOG_NET, "io_uring_enter() failed with " << _batch_remaining
+              << " sends in flight: " << strerror(error));
+    for (size_t i = 0; i < _batch_msgs.size(); ++i) {
+        SendRequest& request = _batch[i];
+        if (request.result < 0 && request.error == EINPROGRESS) {
+            shutdown(request.fd, SHUT_RDWR);
+            request.error = ECONNABORTED;
+        }
+    }
+    _batch_remaining = 0;
+}
@@ -0,0 +1,52 @@
+#include "IrcMessage.hpp"
+
+// Découper une ligne IRC en vues prefix / command / params
+bool IrcMessage::parse(const StringRef& line, IrcMessage& out) {
+    const char* p = line.data;
+    const char* end = line.data + line.length;
+
+    out.prefix = StringRef();
+    out.command = StringRef();
+    out.param_count = 0;
+    out.has_trailing = false;
+
+    // Préfixe optionnel ":nick!user@host"
+    if (p < end && *p == ':') {
+        const char* start = ++p;
+        while (p < end && *p != ' ') ++p;
+        out.prefix = StringRef(start, p - start);
+    }
+
+    // Commande
+    while (p < end && *p == ' ') ++p;
+    const char* cmd_start = p;
+    while (p < end && *p != ' ') ++p;
+    out.command = StringRef(cmd_start, p - cmd_start);
+    if (out.command.empty()) {
+        return false;
+    }
+
+    // Paramètres
+    while (p < end) {
+        while (p < end && *p == ' ') ++p;
+        if (p == end) {
+            break;
+        }
+        // Trailing: le reste de la ligne, espaces compris
+        if (*p == ':') {
+            ++p;
+            out.params[out.param_count++] = StringRef(p, end - p);
+            out.has_trailing = true;
+            break;
+        }
+        // Le 15e paramètre prend le reste de la ligne, même sans ':'
+        if (out.param_count == IRC_MAX_PARAMS - 1) {
+            out.params[out.param_count++] = StringRef(p, end - p);
+            break;
+        }
+        const char* start = p;
+        while (p < end && *p != ' ') ++p;
+        out.params[out.param_count++] = StringRef(start, p - start);
+    }
+    return true;
+}
@@ -0,0 +1,261 @@
+#include "Logger.hpp"
+#include <cstring>
+#include <strings.h>  // pour strcasecmp
+#include <pthread.h>
+#include <unistd.h>
+#include <ctime>
+
+#define LOG_RING_SIZE 4096                  // Nombre de lignes en attente (puissance de 2)
+#define LOG_WRITE_BATCH 65536               // Octets écrits par appel write()
+
+// Case de l'anneau (file bornée de Vyukov)
+// sequence == position: libre pour le producteur; position + 1: prête pour le thread d'écriture.
+struct LogSlot {
+    size_t sequence;
+    int level;
+    size_t length;
+    char text[LOG_LINE_MAX];
+};
+
+int Logger::s_level = LOG_LEVEL_INFO;
+unsigned Logger::s_categories = LOG_ALL;
+
+static LogSlot s_ring[LOG_RING_SIZE];
+static size_t s_enqueue_pos = 0;            // Prochaine case à réserver (producteurs)
+static size_t s_dequeue_pos = 0;            // Prochaine case à lire (thread d'écriture)
+static unsigned long s_dropped = 0;         // Lignes perdues (anneau plein)
+static int s_running = 0;                   // Thread d'écriture actif ?
+static pthread_t s_writer;
+
+static const char* const LEVEL_NAMES[] = { "DEBUG", "INFO", "WARN", "ERROR" };
+
+static const char* const CATEGORY_NAMES[] = { "server", "net", "cmd", "chan", "client" };
+static const size_t CATEGORY_COUNT = sizeof(CATEGORY_NAMES) / sizeof(CATEGORY_NAMES[0]);
+
+// Écrire un buffer en entier (les erreurs du terminal sont ignorées)
+static void writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written <= 0) {
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+// Sortie d'un niveau: les avertissements et erreurs vont sur stderr
+static int outputFd(int level) {
+    return level >= LOG_LEVEL_WARN ? STDERR_FILENO : STDOUT_FILENO;
+}
+
+// Vider l'anneau par lots (un write() par sortie et par lot)
+// Retourne le nombre de lignes écrites.
+static size_t drainRing() {
+    static char out[2][LOG_WRITE_BATCH];
+    size_t out_length[2] = { 0, 0 };
+    size_t count = 0;
+
+    while (true) {
+        LogSlot& slot = s_ring[s_dequeue_pos & (LOG_RING_SIZE - 1)];
+        if (__atomic_load_n(&slot.sequence, __ATOMIC_ACQUIRE) != s_dequeue_pos + 1) {
+            break; // Anneau vide (ou ligne encore en cours d'écriture)
+        }
+        int target = slot.level >= LOG_LEVEL_WARN ? 1 : 0;
+        if (out_length[target] + slot.length > LOG_WRITE_BATCH) {
+            writeAll(outputFd(target ? LOG_LEVEL_WARN : LOG_LEVEL_INFO), out[target], out_length[target]);
+            out_length[target] = 0;
+        }
+        std::memcpy(out[target] + out_length[target], slot.text, slot.length);
+        out_length[target] += slot.length;
+
+        // Rendre la case aux producteurs pour le tour suivant
+        __atomic_store_n(&slot.sequence, s_dequeue_pos + LOG_RING_SIZE, __ATOMIC_RELEASE);
+        ++s_dequeue_pos;
+        ++count;
+    }
+    writeAll(STDOUT_FILENO, out[0], out_length[0]);
+    writeAll(STDERR_FILENO, out[1], out_length[1]);
+
+    unsigned long dropped = __atomic_exchange_n(&s_dropped, 0UL, __ATOMIC_RELAXED);
+    if (dropped > 0) {
+        LogLine(LOG_LEVEL_WARN, LOG_SERVER) << "Log ring full, " << dropped << " lines dropped";
+    }
+    return count;
+}
+
+// Thread d'écriture: attend de plus en plus longtemps tant que l'anneau reste vide
+// (les producteurs ne font jamais d'appel système pour le réveiller)
+static void* writerMain(void*) {
+    long idle_us = 1000;
+    while (__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        if (drainRing() > 0) {
+            idle_us = 1000;
+            continue;
+        }
+        struct timespec delay;
+        delay.tv_sec = 0;
+        delay.tv_nsec = idle_us * 1000;
+        nanosleep(&delay, NULL);
+        if (idle_us < 20000) {
+            idle_us *= 2;
+        }
+    }
+    drainRing();
+    return NULL;
+}
+
+void Logger::start(int level, unsigned categories) {
+    s_level = level;
+    s_categories = categories;
+    for (size_t i = 0; i < LOG_RING_SIZE; ++i) {
+        s_ring[i].sequence = i;
+    }
+    s_enqueue_pos = 0;
+    s_dequeue_pos = 0;
+    __atomic_store_n(&s_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&s_writer, NULL, &writerMain, NULL) != 0) {
+        __atomic_store_n(&s_running, 0, __ATOMIC_RELEASE); // Repli sur l'écriture directe
+    }
+}
+
+void Logger::stop() {
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&s_running, 0, __ATOMIC_RELEASE);
+    pthread_join(s_writer, NULL);
+}
+
+// Réserver une case, y copier la ligne, puis la publier
+void Logger::submit(int level, const char* text, size_t length) {
+    if (!__atomic_load_n(&s_running, __ATOMIC_ACQUIRE)) {
+        writeAll(outputFd(level), text, length);
+        return;
+    }
+
+    size_t pos = __atomic_load_n(&s_enqueue_pos, __ATOMIC_RELAXED);
+    LogSlot* slot;
+    while (true) {
+        slot = &s_ring[pos & (LOG_RING_SIZE - 1)];
+        size_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        long diff = static_cast<long>(sequence) - static_cast<long>(pos);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&s_enqueue_pos, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // Anneau plein: perdre la ligne plutôt que bloquer la boucle d'événements
+            __atomic_add_fetch(&s_dropped, 1UL, __ATOMIC_RELAXED);
+            return;
+        } else {
+            pos = __atomic_load_n(&s_enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+    slot->level = level;
+    slot->length = length;
+    std::memcpy(slot->text, text, length);
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+
+bool Logger::parseLevel(const std::string& name, int& level) {
+    for (int i = LOG_LEVEL_DEBUG; i <= LOG_LEVEL_ERROR; ++i) {
+        if (strcasecmp(name.c_str(), LEVEL_NAMES[i]) == 0) {
+            level = i;
+            return true;
+        }
+    }
+    if (name == "off") {
+        level = LOG_LEVEL_OFF;
+        return true;
+    }
+    return false;
+}
+
+// Liste séparée par des virgules: "net,cmd" ou "all"
+bool Logger::parseCategories(const std::string& list, unsigned& categories) {
+    if (list == "all") {
+        categories = LOG_ALL;
+        return true;
+    }
+    unsigned parsed = 0;
+    size_t start = 0;
+    while (start <= list.length()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) {
+            comma = list.length();
+        }
+        std::string name = list.substr(start, comma - start);
+        size_t i = 0;
+        while (i < CATEGORY_COUNT && name != CATEGORY_NAMES[i]) {
+            ++i;
+        }
+        if (i == CATEGORY_COUNT) {
+            return false;
+        }
+        parsed |= 1u << i;
+        start = comma + 1;
+    }
+    categories = parsed;
+    return true;
+}
+
+// En-tête "LEVEL [catégorie] " écrit dès la construction
+LogLine::LogLine(int level, unsigned category) : _length(0), _level(level) {
+    *this << LEVEL_NAMES[level] << " [";
+    for (size_t i = 0; i < CATEGORY_COUNT; ++i) {
+        if (category & (1u << i)) {
+            *this << CATEGORY_NAMES[i];
+            break;
+        }
+    }
+    *this << "] ";
+}
+
+LogLine::~LogLine() {
+    _buffer[_length++] = '\n';
+    Logger::submit(_level, _buffer, _length);
+}
+
+// Copier en tronquant (un octet est réservé au saut de ligne)
+void LogLine::_append(const char* data, size_t length) {
+    size_t room = LOG_LINE_MAX - 1 - _length;
+    if (length > room) {
+        length = room;
+    }
+    std::memcpy(_buffer + _length, data, length);
+    _length += length;
+}
+
+LogLine& LogLine::operator<<(const char* text) {
+    _append(text, std::strlen(text));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(int value) {
+    return *this << static_cast<long>(value);
+}
+
+LogLine& LogLine::operator<<(long value) {
+    if (value < 0) {
+        _appendUnsigned(0UL - static_cast<unsigned long>(value), true);
+    } else {
+        _appendUnsigned(static_cast<unsigned long>(value), false);
+    }
+    return *this;
+}
+
+// Conversion décimale sans flux ni allocation
+void LogLine::_appendUnsigned(unsigned long value, bool negative) {
+    char digits[24];
+    size_t pos = sizeof(digits);
+    do {
+        digits[--pos] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (negative) {
+        digits[--pos] = '-';
+    }
+    _append(digits + pos, sizeof(digits) - pos);
+}
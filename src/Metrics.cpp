@@ -0,0 +1,183 @@
+#include "Metrics.hpp"
+#include "utils.hpp"  // pour intToString
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+Histogram::Histogram() : count(0), sum(0) {
+    for (size_t i = 0; i < METRICS_BUCKETS; ++i) {
+        buckets[i] = 0;
+    }
+}
+
+// Bucket = nombre de bits significatifs de la valeur
+void Histogram::record(unsigned long value) {
+    size_t bucket = value ? 64 - __builtin_clzl(value) : 0;
+    if (bucket >= METRICS_BUCKETS) {
+        bucket = METRICS_BUCKETS - 1;
+    }
+    metricAdd(buckets[bucket], 1);
+    metricAdd(count, 1);
+    metricAdd(sum, value);
+}
+
+void Histogram::accumulate(const Histogram& other) {
+    for (size_t i = 0; i < METRICS_BUCKETS; ++i) {
+        buckets[i] += metricRead(other.buckets[i]);
+    }
+    count += metricRead(other.count);
+    sum += metricRead(other.sum);
+}
+
+unsigned long Histogram::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    unsigned long rank = static_cast<unsigned long>(fraction * count);
+    unsigned long seen = 0;
+    for (size_t i = 0; i < METRICS_BUCKETS; ++i) {
+        seen += buckets[i];
+        if (seen > rank) {
+            return upperBound(i);
+        }
+    }
+    return upperBound(METRICS_BUCKETS - 1);
+}
+
+Metrics::Metrics() : bytes_in(0), bytes_out(0), accepted(0), accept_batches_capped(0), accept_queue_full(0), clients(0), read_suspensions(0), sendq_evictions(0), flood_throttles(0), 
+                     pings_sent(0), ping_timeouts(0), registration_timeouts(0) {
+    for (size_t i = 0; i <= CMD_COUNT; ++i) {
+        commands[i] = 0;
+    }
+    for (size_t i = 0; i < METRICS_NUMERIC_COUNT; ++i) {
+        numerics[i] = 0;
+    }
+}
+
+void Metrics::accumulate(const Metrics& other) {
+    for (size_t i = 0; i <= CMD_COUNT; ++i) {
+        commands[i] += metricRead(other.commands[i]);
+        command_ns[i].accumulate(other.command_ns[i]);
+    }
+    for (size_t i = 0; i < METRICS_NUMERIC_COUNT; ++i) {
+        numerics[i] += metricRead(other.numerics[i]);
+    }
+    bytes_in += metricRead(other.bytes_in);
+    bytes_out += metricRead(other.bytes_out);
+    accepted += metricRead(other.accepted);
+    accept_batches_capped += metricRead(other.accept_batches_capped);
+    accept_queue_full += metricRead(other.accept_queue_full);
+    accept_queue.accumulate(other.accept_queue);
+    clients += metricRead(other.clients);
+    sendq_bytes.accumulate(other.sendq_bytes);
+    read_suspensions += metricRead(other.read_suspensions);
+    sendq_evictions += metricRead(other.sendq_evictions);
+    flood_throttles += metricRead(other.flood_throttles);
+    pings_sent += metricRead(other.pings_sent);
+    ping_timeouts += metricRead(other.ping_timeouts);
+    registration_timeouts += metricRead(other.registration_timeouts);
+}
+
+static const char* commandName(size_t index) {
+    return index == METRICS_UNKNOWN_COMMAND ? "unknown" : CommandTable::get(static_cast<CommandId>(index)).name;
+}
+
+// Histogramme Prometheus (buckets cumulés, bornes en unités de base)
+static void renderHistogram(std::string& out, const std::string& name, const std::string& labels,
+                            const Histogram& histogram, double scale) {
+    std::string separator = labels.empty() ? "" : ",";
+    unsigned long cumulative = 0;
+    for (size_t i = 0; i < METRICS_BUCKETS; ++i) {
+        cumulative += histogram.buckets[i];
+        std::ostringstream bound;
+        bound << Histogram::upperBound(i) * scale;
+        out += name + "_bucket{" + labels + separator + "le=\"" + bound.str() + "\"} " + intToString(cumulative) + "\n";
+    }
+    std::ostringstream sum;
+    sum << histogram.sum * scale;
+    out += name + "_bucket{" + labels + separator + "le=\"+Inf\"} " + intToString(histogram.count) + "\n";
+    out += name + "_sum{" + labels + "} " + sum.str() + "\n";
+    out += name + "_count{" + labels + "} " + intToString(histogram.count) + "\n";
+}
+
+void MetricsSnapshot::renderPrometheus(std::string& out) const {
+    out += "# TYPE ircserv_commands_total counter\n";
+    for (size_t i = 0; i <= CMD_COUNT; ++i) {
+        out += "ircserv_commands_total{command=\"" + std::string(commandName(i)) + "\"} "
+             + intToString(totals.commands[i]) + "\n";
+    }
+    out += "# TYPE ircserv_command_duration_seconds histogram\n";
+    for (size_t i = 0; i <= CMD_COUNT; ++i) {
+        if (totals.command_ns[i].count > 0) {
+            renderHistogram(out, "ircserv_command_duration_seconds",
+                            "command=\"" + std::string(commandName(i)) + "\"", totals.command_ns[i], 1e-9);
+        }
+    }
+    out += "# TYPE ircserv_error_replies_total counter\n";
+    for (size_t i = 0; i < METRICS_NUMERIC_COUNT; ++i) {
+        if (totals.numerics[i] > 0) {
+            out += "ircserv_error_replies_total{numeric=\"" + intToString(METRICS_NUMERIC_MIN + i) + "\"} "
+                 + intToString(totals.numerics[i]) + "\n";
+        }
+    }
+    out += "# TYPE ircserv_received_bytes_total counter\n";
+    out += "ircserv_received_bytes_total " + intToString(totals.bytes_in) + "\n";
+    out += "# TYPE ircserv_sent_bytes_total counter\n";
+    out += "ircserv_sent_bytes_total " + intToString(totals.bytes_out) + "\n";
+    out += "# TYPE ircserv_accepted_connections_total counter\n";
+    out += "ircserv_accepted_connections_total " + intToString(totals.accepted) + "\n";
+    out += "# TYPE ircserv_accept_batches_capped_total counter\n";
+    out += "ircserv_accept_batches_capped_total " + intToString(totals.accept_batches_capped) + "\n";
+    out += "# TYPE ircserv_accept_queue_full_total counter\n";
+    out += "ircserv_accept_queue_full_total " + intToString(totals.accept_queue_full) + "\n";
+    out += "# TYPE ircserv_accept_queue_length histogram\n";
+    renderHistogram(out, "ircserv_accept_queue_length", "", totals.accept_queue, 1.0);
+    out += "# TYPE ircserv_listen_overflows_total counter\n";
+    out += "ircserv_listen_overflows_total " + intToString(listen_overflows) + "\n";
+    out += "# TYPE ircserv_clients gauge\n";
+    out += "ircserv_clients " + intToString(totals.clients) + "\n";
+    out += "# TYPE ircserv_channels gauge\n";
+    out += "ircserv_channels " + intToString(channels) + "\n";
+    out += "# TYPE ircserv_history_bytes gauge\n";
+    out += "ircserv_history_bytes " + intToString(history_bytes) + "\n";
+    out += "# TYPE ircserv_history_evictions_total counter\n";
+    out += "ircserv_history_evictions_total " + intToString(history_evictions) + "\n";
+    out += "# TYPE ircserv_sendq_bytes histogram\n";
+    renderHistogram(out, "ircserv_sendq_bytes", "", totals.sendq_bytes, 1.0);
+    out += "# TYPE ircserv_read_suspensions_total counter\n";
+    out += "ircserv_read_suspensions_total " + intToString(totals.read_suspensions) + "\n";
+    out += "# TYPE ircserv_sendq_evictions_total counter\n";
+    out += "ircserv_sendq_evictions_total " + intToString(totals.sendq_evictions) + "\n";
+    out += "# TYPE ircserv_flood_throttles_total counter\n";
+    out += "ircserv_flood_throttles_total " + intToString(totals.flood_throttles) + "\n";
+    out += "# TYPE ircserv_pings_sent_total counter\n";
+    out += "ircserv_pings_sent_total " + intToString(totals.pings_sent) + "\n";
+    out += "# TYPE ircserv_ping_timeouts_total counter\n";
+    out += "ircserv_ping_timeouts_total " + intToString(totals.ping_timeouts) + "\n";
+    out += "# TYPE ircserv_registration_timeouts_total counter\n";
+    out += "ircserv_registration_timeouts_total " + intToString(totals.registration_timeouts) + "\n";
+    out += "# TYPE ircserv_uptime_seconds gauge\n";
+    out += "ircserv_uptime_seconds " + intToString(uptime_s) + "\n";
+}
+
+// /proc/net/netstat: une ligne d'en-têtes "TcpExt: ..." suivie d'une ligne de valeurs
+unsigned long readListenOverflows() {
+    std::ifstream file("/proc/net/netstat");
+    std::string names;
+    std::string values;
+    while (std::getline(file, names) && std::getline(file, values)) {
+        if (names.compare(0, 7, "TcpExt:") != 0) {
+            continue;
+        }
+        std::istringstream name_stream(names);
+        std::istringstream value_stream(values);
+        std::string name;
+        std::string value;
+        while (name_stream >> name && value_stream >> value) {
+            if (name == "ListenOverflows") {
+                return std::strtoul(value.c_str(), NULL, 10);
+            }
+        }
+    }
+    return 0;
+}
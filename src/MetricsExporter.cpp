@@ -0,0 +1,119 @@
+#include "MetricsExporter.hpp"
+#include "Server.hpp"
+#include "Metrics.hpp"
+#include "Logger.hpp"
+#include <stdexcept>
+#include <cstring>    // pour strerror
+#include <cerrno>     // pour errno
+#include <poll.h>
+#include <sys/time.h>
+#include "utils.hpp"  // pour intToString
+
+#define METRICS_POLL_MS 250                 // Période de vérification de l'arrêt
+#define METRICS_REQUEST_MAX 4096            // Taille maximale lue d'une requête
+
+MetricsExporter::MetricsExporter(Server* server, int port) 
+    : _server(server), _listen_fd(-1), _thread_started(false) {
+    _listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (_listen_fd < 0) {
+        throw std::runtime_error("Failed to create metrics socket: " + std::string(strerror(errno)));
+    }
+    int opt = 1;
+    setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    
+    // Uniquement en local: les métriques ne sont pas authentifiées
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(_listen_fd, 8) < 0) {
+        std::string error = strerror(errno);
+        close(_listen_fd);
+        throw std::runtime_error("Failed to listen on metrics port " + intToString(port) + ": " + error);
+    }
+    LOG_INFO(LOG_SERVER, "Metrics available on http://127.0.0.1:" << port << "/metrics");
+}
+
+MetricsExporter::~MetricsExporter() {
+    join();
+    if (_listen_fd != -1) {
+        close(_listen_fd);
+    }
+}
+
+void MetricsExporter::startThread() {
+    int err = pthread_create(&_thread, NULL, &MetricsExporter::_threadMain, this);
+    if (err != 0) {
+        throw std::runtime_error("Failed to start metrics thread: " + std::string(strerror(err)));
+    }
+    _thread_started = true;
+}
+
+void MetricsExporter::join() {
+    if (_thread_started) {
+        pthread_join(_thread, NULL);
+        _thread_started = false;
+    }
+}
+
+void* MetricsExporter::_threadMain(void* arg) {
+    static_cast<MetricsExporter*>(arg)->_serve();
+    return NULL;
+}
+
+void MetricsExporter::_serve() {
+    while (_server->isRunning()) {
+        struct pollfd pfd;
+        pfd.fd = _listen_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, METRICS_POLL_MS) <= 0) {
+            continue; // Délai écoulé (ou signal): revérifier l'arrêt
+        }
+        int fd = accept(_listen_fd, NULL, NULL);
+        if (fd < 0) {
+            continue;
+        }
+        _handleConnection(fd);
+        close(fd);
+    }
+}
+
+// Une requête par connexion; le chemin demandé est ignoré
+void MetricsExporter::_handleConnection(int fd) {
+    struct timeval timeout;
+    timeout.tv_sec = 1;
+    timeout.tv_usec = 0;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    
+    // Lire jusqu'à la fin des en-têtes pour ne pas fermer sur des données non lues
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < METRICS_REQUEST_MAX) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return;
+        }
+        request.append(buffer, received);
+    }
+    
+    MetricsSnapshot snapshot;
+    _server->collectMetrics(snapshot);
+    std::string body;
+    snapshot.renderPrometheus(body);
+    
+    std::string response = "HTTP/1.0 200 OK\r\n"
+                           "Content-Type: text/plain; version=0.0.4\r\n"
+                           "Content-Length: " + intToString(body.size()) + "\r\n"
+                           "Connection: close\r\n\r\n" + body;
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t written = send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return;
+        }
+        sent += written;
+    }
+}
@@ -0,0 +1,85 @@
+#include "NumericReply.hpp"
+#include <cstring>
+
+// Table indexée par NumericId (même ordre que l'enum)
+static const NumericInfo g_numerics[NUMERIC_COUNT] = {
+    // id                     code   format (après "<code> <cible> ")
+    { RPL_WELCOME,           "001", ":Welcome to the Internet Relay Network %" },
+    { RPL_YOURHOST,          "002", ":Your host is localhost, running version 1.0" },
+    { RPL_CREATED,           "003", ":This server was created today" },
+    { RPL_MYINFO,            "004", "localhost 1.0 o o" },
+    { RPL_ISUPPORT,          "005", "% :are supported by this server" },
+    { RPL_ENDOFSTATS,        "219", "% :End of STATS report" },
+    { RPL_STATSUPTIME,       "242", ":Server Up %" },
+    { RPL_CHANNELMODEIS,     "324", "% +" },
+    { RPL_NOTOPIC,           "331", "% :No topic is set" },
+    { RPL_TOPIC,             "332", "% :%" },
+    { RPL_INVITING,          "341", "% %" },
+    { RPL_YOUREOPER,         "381", ":You are now an IRC operator" },
+    { ERR_NOSUCHNICK,        "401", "% :No such nick/channel" },
+    { ERR_NOSUCHCHANNEL,     "403", "% :No such channel" },
+    { ERR_CHANNELLIMIT,      "403", "% :Cannot create channel, server limit reached" },
+    { ERR_CANNOTSENDTOCHAN,  "404", "% :Cannot send to channel" },
+    { ERR_INPUTTOOLONG,      "417", ":Input line was too long" },
+    { ERR_UNKNOWNCOMMAND,    "421", "% :Unknown command" },
+    { ERR_NONICKNAMEGIVEN,   "431", ":No nickname given" },
+    { ERR_NICKNAMEINUSE,     "433", "% :Nickname is already in use" },
+    { ERR_USERNOTINCHANNEL,  "441", "% % :They aren't on that channel" },
+    { ERR_NOTONCHANNEL,      "442", "% :You're not on that channel" },
+    { ERR_USERONCHANNEL,     "443", "% % :is already on channel" },
+    { ERR_NOTREGISTERED,     "451", ":You have not registered" },
+    { ERR_NEEDMOREPARAMS,    "461", "% :Not enough parameters" },
+    { ERR_ALREADYREGISTRED,  "462", ":You may not reregister" },
+    { ERR_PASSWDMISMATCH,    "464", ":Password incorrect" },
+    { ERR_CHANNELISFULL,     "471", "% :Cannot join channel (+l)" },
+    { ERR_UNKNOWNMODE,       "472", "% :is unknown mode char to me" },
+    { ERR_INVITEONLYCHAN,    "473", "% :Cannot join channel (+i)" },
+    { ERR_BADCHANNELKEY,     "475", "% :Cannot join channel (+k)" },
+    { ERR_NOPRIVILEGES,      "481", ":Permission Denied- You're not an IRC operator" },
+    { ERR_CHANOPRIVSNEEDED,  "482", "% :You're not channel operator" },
+    { ERR_NOOPERHOST,        "491", ":No O-lines for your host" }
+};
+
+const NumericInfo& NumericReply::get(NumericId id) {
+    return g_numerics[id];
+}
+
+// Copier en réservant la place du CRLF final
+void NumericReply::_append(const char* data, size_t length) {
+    size_t room = REPLY_MAX_LENGTH - 2 - _length;
+    if (length > room) {
+        length = room;
+    }
+    std::memcpy(_data + _length, data, length);
+    _length += length;
+}
+
+// "<code> <cible> " puis le format, argument par argument
+NumericReply::NumericReply(NumericId id, const StringRef& target, const StringRef& arg1,
+                           const StringRef& arg2, const StringRef& arg3) : _length(0) {
+    const NumericInfo& info = g_numerics[id];
+    const StringRef* args[3] = { &arg1, &arg2, &arg3 };
+    size_t next_arg = 0;
+
+    _append(info.code, 3);
+    _append(" ", 1);
+    _append(target.data, target.length);
+    _append(" ", 1);
+
+    const char* literal = info.format;
+    const char* p = info.format;
+    for (; *p != '\0'; ++p) {
+        if (*p != '%') {
+            continue;
+        }
+        _append(literal, p - literal);
+        if (next_arg < 3) {
+            _append(args[next_arg]->data, args[next_arg]->length);
+            ++next_arg;
+        }
+        literal = p + 1;
+    }
+    _append(literal, p - literal);
+    _data[_length++] = '\r';
+    _data[_length++] = '\n';
+}
@@ -0,0 +1,90 @@
+#include "PollEngine.hpp"
+
+PollEngine::PollEngine() {
+}
+
+PollEngine::~PollEngine() {
+}
+
+// Ajouter un file descriptor à la surveillance poll()
+bool PollEngine::add(int fd, int interest, void* data) {
+    if (fd < 0) {
+        return false;
+    }
+    if (static_cast<size_t>(fd) >= _index_of.size()) {
+        _index_of.resize(fd + 1, -1);
+    }
+    if (_index_of[fd] != -1) {
+        return modify(fd, interest, data);
+    }
+
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = 0;
+    pfd.revents = 0;
+    if (interest & EVENT_READ)  pfd.events |= POLLIN;
+    if (interest & EVENT_WRITE) pfd.events |= POLLOUT;
+
+    _index_of[fd] = static_cast<int>(_poll_fds.size());
+    _poll_fds.push_back(pfd);
+    _data.push_back(data);
+    return true;
+}
+
+// Modifier les intérêts d'un fd déjà surveillé
+bool PollEngine::modify(int fd, int interest, void* data) {
+    if (fd < 0 || static_cast<size_t>(fd) >= _index_of.size() || _index_of[fd] == -1) {
+        return false;
+    }
+    size_t i = _index_of[fd];
+    _poll_fds[i].events = 0;
+    if (interest & EVENT_READ)  _poll_fds[i].events |= POLLIN;
+    if (interest & EVENT_WRITE) _poll_fds[i].events |= POLLOUT;
+    _data[i] = data;
+    return true;
+}
+
+// Supprimer un fd en O(1): le dernier élément prend sa place
+void PollEngine::remove(int fd) {
+    if (fd < 0 || static_cast<size_t>(fd) >= _index_of.size() || _index_of[fd] == -1) {
+        return;
+    }
+    size_t i = _index_of[fd];
+    size_t last = _poll_fds.size() - 1;
+    if (i != last) {
+        _poll_fds[i] = _poll_fds[last];
+        _data[i] = _data[last];
+        _index_of[_poll_fds[i].fd] = static_cast<int>(i);
+    }
+    _poll_fds.pop_back();
+    _data.pop_back();
+    _index_of[fd] = -1;
+}
+
+// poll() surveille tous les file descriptors, puis on collecte ceux qui sont prêts
+int PollEngine::wait(std::vector<IoEvent>& events, int timeout_ms) {
+    events.clear();
+    if (_poll_fds.empty()) {
+        return 0;
+    }
+
+    int poll_result = poll(&_poll_fds[0], _poll_fds.size(), timeout_ms);
+    if (poll_result <= 0) {
+        return poll_result;
+    }
+
+    for (size_t i = 0; i < _poll_fds.size() && static_cast<int>(events.size()) < poll_result; ++i) {
+        short revents = _poll_fds[i].revents;
+        if (revents == 0) {
+            continue;
+        }
+        IoEvent ev;
+        ev.data = _data[i];
+        ev.events = 0;
+        if (revents & POLLIN)                         ev.events |= EVENT_READ;
+        if (revents & POLLOUT)                        ev.events |= EVENT_WRITE;
+        if (revents & (POLLHUP | POLLERR | POLLNVAL)) ev.events |= EVENT_ERROR;
+        events.push_back(ev);
+    }
+    return static_cast<int>(events.size());
+}
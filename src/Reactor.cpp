@@ -0,0 +1,943 @@
+#include "Reactor.hpp"
+#include "Server.hpp"
+#include "Client.hpp"
+#include "Channel.hpp"
+#include "Logger.hpp"
+#include "NumericReply.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <new>        // pour le placement new
+#include <cstring>    // pour strerror
+#include <cerrno>     // pour errno
+#include <sys/eventfd.h>
+#include <netinet/tcp.h>  // pour TCP_INFO
+#include "utils.hpp"  // pour intToString, monotonicMs
+
+// Reactor du thread courant
+static __thread Reactor* t_current_reactor = NULL;
+
+// Identifiants uniques des clients (jamais réutilisés, contrairement aux fds)
+static unsigned long g_next_client_id = 0;
+
+// Capacité du pool d'un shard: tout max-clients (la limite globale est vérifiée
+// avant chaque allocation), sans borne si max-clients vaut 0
+static size_t clientPoolCapacity(const ServerConfig& config) {
+    return config.max_clients > 0 ? static_cast<size_t>(config.max_clients) : static_cast<size_t>(-1);
+}
+
+// Seuil de suspension de lecture: configuré, sinon la moitié du plafond
+static size_t sendqSoftLimit(const ServerConfig& config) {
+    if (config.sendq_soft_bytes == 0 || config.sendq_soft_bytes > config.sendq_bytes) {
+        return config.sendq_bytes / 2;
+    }
+    return config.sendq_soft_bytes;
+}
+
+Reactor::Reactor(Server* server, int index) 
+    : _server(server), _index(index), _listen_fd(-1), _wake_fd(-1), _accept_pending(false), _engine(NULL), 
+      _thread_started(false), _client_pool(clientPoolCapacity(server->getConfig())), _epoch(1), 
+      _dirty_since_ms(0), _sendq_hard(server->getConfig().sendq_bytes), 
+      _sendq_soft(sendqSoftLimit(server->getConfig())), _now_ms(monotonicMs()), _timers(_now_ms), 
+      _accept_sample_timer(0, this), _wake_pending(0) {
+    _timers.schedule(&_accept_sample_timer, _now_ms + ACCEPT_SAMPLE_INTERVAL_MS);
+}
+
+// Destructeur : fermer les sockets et libérer les clients du shard
+Reactor::~Reactor() {
+    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
+        _client_pool.destroy(it->second);  // Supprimer l'objet Client
+        close(it->first);   // Fermer le socket
+    }
+    _clients.clear();
+    _retireClosed();
+    _reclaim(true); // Tous les threads sont arrêtés
+    
+    // Lots jamais livrés
+    while (MpscNode* node = _inbox.pop()) {
+        delete node;
+    }
+    for (size_t i = 0; i < _outgoing.size(); ++i) {
+        delete _outgoing[i];
+    }
+    
+    if (_listen_fd != -1) {
+        close(_listen_fd);
+    }
+    if (_wake_fd != -1) {
+        close(_wake_fd);
+    }
+    delete _engine;
+}
+
+Reactor* Reactor::current() {
+    return t_current_reactor;
+}
+
+void Reactor::setCurrent(Reactor* reactor) {
+    t_current_reactor = reactor;
+}
+
+// Créer le listener du shard, l'eventfd de réveil et le moteur d'événements
+void Reactor::open() {
+    _setupSocket();     // Créer et configurer le socket
+    _bindAndListen();   // Bind sur le port et mettre en écoute
+    
+    _wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_wake_fd < 0) {
+        throw std::runtime_error("Failed to create eventfd: " + std::string(strerror(errno)));
+    }
+    
+    // Créer le moteur d'événements (repli sur poll si nécessaire)
+    _engine = EventEngine::create(_server->getConfig().engine);
+    
+    // Données utilisateur: &_listen_fd / &_wake_fd, sinon un Client*
+    if (!_engine->addListener(_listen_fd, &_listen_fd) || 
+        !_engine->add(_wake_fd, EVENT_READ, &_wake_fd)) {
+        throw std::runtime_error("Failed to watch server sockets: " + std::string(strerror(errno)));
+    }
+}
+
+// Créer et configurer le socket serveur
+void Reactor::_setupSocket() {
+    // Créer un socket TCP IPv4 non-bloquant
+    _listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_listen_fd < 0) {
+        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
+    }
+    
+    // Option SO_REUSEADDR : permet de réutiliser l'adresse immédiatement
+    int opt = 1;
+    if (setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        throw std::runtime_error("Failed to set SO_REUSEADDR: " + std::string(strerror(errno)));
+    }
+    
+    // Option SO_REUSEPORT : chaque shard a son listener, le noyau répartit les connexions
+    if (setsockopt(_listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        throw std::runtime_error("Failed to set SO_REUSEPORT: " + std::string(strerror(errno)));
+    }
+}
+
+// Associer le socket à une adresse et mettre en écoute
+void Reactor::_bindAndListen() {
+    struct sockaddr_in server_addr;
+    std::memset(&server_addr, 0, sizeof(server_addr));
+    server_addr.sin_family = AF_INET;         // IPv4
+    server_addr.sin_addr.s_addr = INADDR_ANY; // Écouter sur toutes les interfaces
+    server_addr.sin_port = htons(_server->getPort()); // Port en format réseau (big-endian)
+    
+    // Associer le socket à l'adresse
+    if (bind(_listen_fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        throw std::runtime_error("Failed to bind to port " + intToString(_server->getPort()) + ": " + std::string(strerror(errno)));
+    }
+    
+    // Mettre le socket en mode écoute (un pic de reconnexions doit tenir dans la file)
+    if (listen(_listen_fd, _server->getConfig().listen_backlog) < 0) {
+        throw std::runtime_error("Failed to listen on socket: " + std::string(strerror(errno)));
+    }
+}
+
+// Lancer la boucle dans un nouveau thread
+void Reactor::startThread() {
+    int err = pthread_create(&_thread, NULL, &Reactor::_threadMain, this);
+    if (err != 0) {
+        throw std::runtime_error("Failed to start reactor thread: " + std::string(strerror(err)));
+    }
+    _thread_started = true;
+}
+
+void* Reactor::_threadMain(void* arg) {
+    Reactor* reactor = static_cast<Reactor*>(arg);
+    try {
+        reactor->run();
+    } catch (const std::exception& e) {
+        LOG_ERROR(LOG_SERVER, "Error in reactor " << reactor->_index << ": " << e.what());
+        reactor->_server->stop();
+    }
+    return NULL;
+}
+
+void Reactor::join() {
+    if (_thread_started) {
+        pthread_join(_thread, NULL);
+        _thread_started = false;
+    }
+}
+
+// Réveiller la boucle: un seul write() tant que le réveil n'a pas été consommé
+void Reactor::wake() {
+    if (__atomic_exchange_n(&_wake_pending, 1, __ATOMIC_SEQ_CST) == 0) {
+        uint64_t one = 1;
+        ssize_t written = write(_wake_fd, &one, sizeof(one));
+        (void)written; // EAGAIN: compteur saturé, la boucle est de toute façon réveillée
+    }
+}
+
+// Boucle principale du shard
+// Le moteur ne renvoie que les fds prêts, chacun avec son Client* associé.
+void Reactor::run() {
+    t_current_reactor = this;
+    
+    while (_server->isRunning()) {
+        _setQuiescent(true);
+        int ready = _engine->wait(_events, _computeWaitTimeout());
+        _setQuiescent(false);
+        _now_ms = monotonicMs(); // Horloge de toute l'itération (timers, flood, inactivité)
+        
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue; // Interrompu par un signal (normal), continuer
+            }
+            throw std::runtime_error(std::string(_engine->getName()) + " wait failed: " + std::string(strerror(errno)));
+        }
+        
+        bool accepted = false;
+        for (size_t i = 0; i < _events.size(); ++i) {
+            const IoEvent& ev = _events[i];
+            
+            // Le socket serveur a des connexions en attente
+            if (ev.data == &_listen_fd) {
+                _acceptNewClients();
+                accepted = true;
+                continue;
+            }
+            // Un autre shard nous a livré des messages (ou arrêt demandé)
+            if (ev.data == &_wake_fd) {
+                uint64_t count;
+                while (read(_wake_fd, &count, sizeof(count)) > 0) {
+                }
+                continue;
+            }
+            
+            Client* client = static_cast<Client*>(ev.data);
+            if (client->isDisconnected()) {
+                continue; // Déjà déconnecté plus tôt dans cette itération
+            }
+            
+            // Le socket peut de nouveau accepter des données en attente
+            if (ev.events & EVENT_WRITE) {
+                _flushClient(client);
+            }
+            // Un client existant a envoyé des données (ou fermé la connexion)
+            if ((ev.events & EVENT_READ) && !client->isDisconnected()) {
+                _handleClientData(client);
+            }
+            // Erreur sur un socket (connexion fermée, etc.)
+            else if ((ev.events & EVENT_ERROR) && !client->isDisconnected()) {
+                LOG_INFO(LOG_NET, "Client disconnected (socket error)");
+                disconnectClient(client, "Connection error");
+            }
+        }
+        
+        // Lot d'accept plafonné à l'itération précédente: aucun nouvel événement n'arrivera
+        if (_accept_pending && !accepted) {
+            _acceptNewClients();
+        }
+        _runTimers();
+        _resumeClients();
+        _drainInbox();
+        _sendOutgoing();
+        _evictSlowClients();
+        
+        // Un seul envoi par client pour toutes les réponses de l'itération
+        _flushDirtyClients();
+        _retireClosed();
+        _reclaim(false);
+        _arena.reset();
+    }
+    
+    _setQuiescent(true);
+    t_current_reactor = NULL;
+}
+
+// Accepter les connexions en attente jusqu'à EAGAIN (requis en edge-triggered),
+// au plus accept_batch par itération: lors d'une vague de reconnexions, les clients
+// déjà connectés continuent d'être servis entre deux lots.
+void Reactor::_acceptNewClients() {
+    _accept_pending = false;
+    
+    int batch = _server->getConfig().accept_batch;
+    for (int attempt = 0; attempt < batch; ++attempt) {
+        struct sockaddr_in client_addr;
+        socklen_t client_len = sizeof(client_addr);
+        
+        // Accepter la connexion, déjà non-bloquante (pas de fcntl séparé)
+        int client_fd = _engine->accept(_listen_fd, (struct sockaddr*)&client_addr, &client_len);
+        
+        if (client_fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EWOULDBLOCK && errno != EAGAIN) {
+                LOG_ERROR(LOG_NET, "Failed to accept client: " << strerror(errno));
+            }
+            return; // Plus de connexion en attente (ou erreur non fatale)
+        }
+        
+        // Récupérer l'adresse IP du client
+        char ip_buffer[INET_ADDRSTRLEN];
+        std::string client_ip = inet_ntop(AF_INET, &client_addr.sin_addr, ip_buffer, sizeof(ip_buffer));
+        
+        // Créer un objet Client pour ce nouveau client, rattaché à ce shard
+        if (!_server->_reserveClient()) {
+            _rejectClient(client_fd);
+            continue;
+        }
+        void* slot = _client_pool.allocate();
+        if (slot == NULL) {
+            _server->_releaseClient();
+            _rejectClient(client_fd);
+            continue;
+        }
+        unsigned long id = __atomic_add_fetch(&g_next_client_id, 1, __ATOMIC_RELAXED);
+        Client* new_client = new (slot) Client(client_fd, client_ip, _server->getConfig().recvq_bytes);
+        new_client->setOwner(this, id);
+        new_client->getFloodBucket().reset(_server->getConfig().flood_burst, _now_ms);
+        new_client->markConnected(_now_ms);
+        
+        // Enregistrer le fd avec son Client* comme donnée utilisateur
+        if (!_engine->addConnection(client_fd, EVENT_READ, new_client)) {
+            LOG_ERROR(LOG_NET, "Failed to watch client socket: " << strerror(errno));
+            _client_pool.destroy(new_client);
+            _server->_releaseClient();
+            close(client_fd);
+            continue;
+        }
+        _clients[client_fd] = new_client;
+        _startKeepalive(new_client);
+        metricAdd(_metrics.accepted, 1);
+        metricSet(_metrics.clients, _clients.size());
+        
+        LOG_INFO(LOG_NET, "New client connected from " << client_ip 
+                  << " (fd: " << client_fd << ", shard: " << _index << ")");
+    }
+    
+    // Plafond atteint: la suite sera acceptée à l'itération suivante
+    _accept_pending = true;
+    metricAdd(_metrics.accept_batches_capped, 1);
+}
+
+// Mesurer la file d'accept du listener (timer périodique, hors du chemin d'accept)
+// Pour un socket en écoute, TCP_INFO donne sa longueur (tcpi_unacked) et son
+// plafond (tcpi_sacked); une file pleine signifie que le noyau rejette des SYN/ACK.
+// Le compteur ListenOverflows (tout le système) n'est relevé que par le premier shard.
+void Reactor::_sampleAcceptQueue() {
+    if (_index == 0) {
+        metricSet(_server->_listen_overflows, readListenOverflows());
+    }
+    struct tcp_info info;
+    socklen_t length = sizeof(info);
+    if (getsockopt(_listen_fd, IPPROTO_TCP, TCP_INFO, &info, &length) < 0) {
+        return;
+    }
+    _metrics.accept_queue.record(info.tcpi_unacked);
+    if (info.tcpi_unacked >= info.tcpi_sacked) {
+        metricAdd(_metrics.accept_queue_full, 1);
+        LOG_WARN(LOG_NET, "Accept queue full on shard " << _index << " (" << info.tcpi_unacked 
+                 << " pending connections)");
+    }
+}
+
+// Refuser une connexion quand max-clients est atteint (ou le pool à court de mémoire)
+// Envoi direct et sans attente: le socket n'est jamais enregistré.
+void Reactor::_rejectClient(int client_fd) {
+    static const char error[] = "ERROR :Closing Link: Server full\r\n";
+    LOG_WARN(LOG_NET, "Client limit reached on shard " << _index << ", rejecting fd " << client_fd);
+    send(client_fd, error, sizeof(error) - 1, MSG_NOSIGNAL | MSG_DONTWAIT);
+    close(client_fd);
+}
+
+// Traiter les données reçues d'un client
+// La réception écrit directement dans la RecvQ circulaire; lit jusqu'à EAGAIN car
+// en edge-triggered aucun nouvel événement n'arrivera sinon. Les lignes déjà
+// en RecvQ (laissées par une suspension de lecture) passent avant toute lecture.
+void Reactor::_handleClientData(Client* client) {
+    int client_fd = client->getFd();
+    RecvBuffer& recv_buffer = client->getRecvBuffer();
+    
+    while (true) {
+        _processLines(client);
+        if (client->isDisconnected()) {
+            return;
+        }
+        if (client->isReadSuspended()) {
+            // SendQ trop pleine: ne plus surveiller la lecture jusqu'à la vidange
+            _updateInterest(client);
+            return;
+        }
+        
+        struct iovec iov[2];
+        int regions = recv_buffer.writableRegions(iov);
+        if (regions == 0) {
+            // RecvQ pleine de lignes non traitées
+            bool flooding = client->isFloodThrottled();
+            if (flooding && !_server->getConfig().flood_disconnect) {
+                // Ne plus lire: le client reste bloqué par TCP jusqu'au retour du crédit
+                _updateInterest(client);
+                return;
+            }
+            std::string reason = flooding ? "Excess Flood" : "RecvQ exceeded";
+            LOG_WARN(LOG_NET, reason << " for client " << client_fd);
+            _closeLink(client, reason);
+            return;
+        }
+        if (!client->hasReadInterest()) {
+            _updateInterest(client); // Lecture bloquée puis débloquée: surveiller avant de lire
+        }
+        
+        // Recevoir les données
+        ssize_t bytes_received = _engine->receive(client_fd, iov, regions);
+        
+        if (bytes_received < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return; // Plus rien à lire pour l'instant
+        }
+        if (bytes_received <= 0) {
+            if (bytes_received == 0) {
+                LOG_INFO(LOG_NET, "Client " << client_fd << " disconnected");
+            } else {
+                LOG_ERROR(LOG_NET, "Error receiving from client " << client_fd 
+                          << ": " << strerror(errno));
+            }
+            disconnectClient(client, "Client closed connection");
+            return;
+        }
+        recv_buffer.commit(bytes_received);
+        client->markActive(_now_ms);
+        metricAdd(_metrics.bytes_in, bytes_received);
+    }
+}
+
+// Traiter tous les messages complets disponibles (vues sur le buffer)
+// S'arrête dès que la lecture est suspendue: les lignes restantes attendent la reprise.
+// Avec le contrôle de flood, chaque ligne consomme son coût (table des commandes);
+// à court de crédit, les lignes restantes attendent en RecvQ (fake lag).
+void Reactor::_processLines(Client* client) {
+    const ServerConfig& config = _server->getConfig();
+    RecvBuffer& recv_buffer = client->getRecvBuffer();
+    TokenBucket& bucket = client->getFloodBucket();
+    if (config.flood_rate > 0) {
+        bucket.refill(_now_ms, config.flood_rate, config.flood_burst);
+    }
+    
+    StringRef message;
+    RecvBuffer::LineStatus status;
+    while (!client->isDisconnected() && !client->isReadSuspended()) {
+        if (config.flood_rate > 0 && !bucket.available()) {
+            if (recv_buffer.size() > 0) {
+                _throttleClient(client);
+            }
+            return;
+        }
+        status = recv_buffer.nextLine(message);
+        if (status == RecvBuffer::LINE_NONE) {
+            return;
+        }
+        if (status == RecvBuffer::LINE_TOO_LONG) {
+            // Le nickname n'est modifié que par ce thread (commande NICK du client)
+            NumericReply reply(ERR_INPUTTOOLONG, client->getNickname().empty() ? StringRef("*") : StringRef(client->getNickname()));
+            enqueue(client, reply.data(), reply.length());
+            continue;
+        }
+        
+        // Parser et traiter la commande IRC (le handler verrouille ce qu'il touche)
+        int cost = _server->_parseCommand(client, message);
+        if (config.flood_rate > 0) {
+            bucket.consume(cost);
+        }
+    }
+}
+
+// Déconnecter un client du shard
+// L'objet Client n'est libéré qu'après la période de grâce: d'autres événements de
+// la même itération, ou d'autres reactors (listes de membres), peuvent encore pointer dessus.
+void Reactor::disconnectClient(Client* client, const std::string& reason) {
+    if (client->isDisconnected()) {
+        return;
+    }
+    int client_fd = client->getFd();
+    
+    // Quitter les channels et libérer le nickname (état partagé)
+    _server->_detachClient(client, reason);
+    
+    _clients.erase(client_fd);
+    metricSet(_metrics.clients, _clients.size());
+    if (client->isFlushPending()) {
+        // La fenêtre de batching peut survivre à l'itération: ne pas garder de pointeur
+        _dirty_clients.erase(std::find(_dirty_clients.begin(), _dirty_clients.end(), client));
+        client->setFlushPending(false);
+    }
+    std::vector<Client*>::iterator resume = std::find(_resume_clients.begin(), _resume_clients.end(), client);
+    if (resume != _resume_clients.end()) {
+        _resume_clients.erase(resume);
+    }
+    _timers.cancel(&client->getKeepaliveTimer());
+    _timers.cancel(&client->getFloodTimer());
+    client->setFloodThrottled(false);
+    _closed_clients.push_back(client);
+    
+    // Retirer du moteur et fermer le socket
+    _engine->remove(client_fd);
+    close(client_fd);
+    
+    LOG_DEBUG(LOG_NET, "Client " << client_fd << " fully disconnected");
+}
+
+// Un channel vidé sur ce thread: même période de grâce que les clients
+void Reactor::retire(Channel* channel) {
+    _closed_channels.push_back(channel);
+}
+
+// État quiescent (QSBR): bloqué dans wait(), le reactor ne tient aucune référence vers
+// l'état partagé. Époque impaire pendant l'attente, paire pendant l'itération.
+void Reactor::_setQuiescent(bool quiescent) {
+    if (((_epoch & 1) != 0) != quiescent) {
+        __atomic_store_n(&_epoch, _epoch + 1, __ATOMIC_SEQ_CST);
+    }
+}
+
+// Regrouper ce qui a été retiré pendant l'itération, avec l'époque de chaque reactor
+void Reactor::_retireClosed() {
+    if (_closed_clients.empty() && _closed_channels.empty()) {
+        return;
+    }
+    RetiredBatch* batch = new RetiredBatch;
+    batch->clients.swap(_closed_clients);
+    batch->channels.swap(_closed_channels);
+    for (size_t i = 0; i < _server->getReactorCount(); ++i) {
+        batch->epochs.push_back(_server->getReactor(i)->getEpoch());
+    }
+    _retired.push_back(batch);
+}
+
+// Période de grâce écoulée: chaque autre reactor était en attente au retrait,
+// ou a changé d'époque depuis (il a donc fini l'itération qui pouvait les voir)
+bool Reactor::_graceElapsed(const RetiredBatch& batch) const {
+    for (size_t i = 0; i < batch.epochs.size(); ++i) {
+        unsigned long epoch = batch.epochs[i];
+        if (static_cast<int>(i) != _index && (epoch & 1) == 0 && _server->getReactor(i)->getEpoch() == epoch) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Libérer les lots dans l'ordre de retrait (force: arrêt, plus aucun autre thread)
+void Reactor::_reclaim(bool force) {
+    while (!_retired.empty() && (force || _graceElapsed(*_retired.front()))) {
+        RetiredBatch* batch = _retired.front();
+        _retired.pop_front();
+        for (size_t i = 0; i < batch->clients.size(); ++i) {
+            _client_pool.destroy(batch->clients[i]);
+            _server->_releaseClient();
+        }
+        for (size_t i = 0; i < batch->channels.size(); ++i) {
+            _server->_destroyChannel(batch->channels[i]);
+        }
+        delete batch;
+    }
+}
+
+// Mettre en file un message pour un client de ce shard
+// L'envoi réel a lieu en fin d'itération.
+void Reactor::enqueue(Client* client, const SharedBuffer& message) {
+    if (client->isDisconnected() || client->isSendqExceeded()) {
+        return;
+    }
+    client->getSendQueue().push(message);
+    _queued(client);
+}
+
+// Réponse propre au client: copiée dans sa SendQ, sans SharedBuffer intermédiaire
+void Reactor::enqueue(Client* client, const char* data, size_t length) {
+    if (client->isDisconnected() || client->isSendqExceeded()) {
+        return;
+    }
+    client->getSendQueue().append(data, length);
+    _queued(client);
+}
+
+// Limites de SendQ et inscription parmi les clients à vider
+void Reactor::_queued(Client* client) {
+    SendQueue& queue = client->getSendQueue();
+    client->updateQueuedBytes();
+    
+    if (queue.size() > _sendq_hard) {
+        // Déconnexion différée: on peut être dans un handler, sous le verrou d'un channel
+        client->markSendqExceeded();
+        _slow_clients.push_back(client);
+        return;
+    }
+    if (queue.size() > _sendq_soft && !client->isReadSuspended()) {
+        // Ses propres commandes ne feraient qu'ajouter des réponses à sa file
+        client->setReadSuspended(true);
+        metricAdd(_metrics.read_suspensions, 1);
+        LOG_DEBUG(LOG_NET, "Suspending reads from client " << client->getFd() 
+                  << " (SendQ " << queue.size() << " bytes)");
+    }
+    
+    // Si une écriture est déjà en attente, le socket est plein: EVENT_WRITE s'en chargera
+    if (!client->isFlushPending() && !client->hasWriteInterest()) {
+        if (_dirty_clients.empty()) {
+            _dirty_since_ms = _now_ms;
+        }
+        client->setFlushPending(true);
+        _dirty_clients.push_back(client);
+    }
+}
+
+// Préparer la livraison d'un message à un client d'un autre shard
+// Les messages sont regroupés par shard et publiés une fois par itération.
+void Reactor::route(Client* client, const SharedBuffer& message) {
+    Reactor* owner = client->getReactor();
+    size_t target = owner->getIndex();
+    if (_outgoing.size() <= target) {
+        _outgoing.resize(target + 1, static_cast<Delivery*>(NULL));
+    }
+    if (_outgoing[target] == NULL) {
+        _outgoing[target] = new Delivery;
+    }
+    ClientRef ref;
+    ref.client = client;
+    ref.fd = client->getFd();
+    ref.id = client->getId();
+    _outgoing[target]->targets.push_back(ref);
+    _outgoing[target]->messages.push_back(message);
+}
+
+// Publier les lots préparés: un push et au plus un réveil par shard destinataire
+void Reactor::_sendOutgoing() {
+    for (size_t i = 0; i < _outgoing.size(); ++i) {
+        if (_outgoing[i] != NULL) {
+            Reactor* target = _server->getReactor(i);
+            target->_inbox.push(_outgoing[i]);
+            _outgoing[i] = NULL;
+            target->wake();
+        }
+    }
+}
+
+// Livrer les messages reçus des autres shards
+// Chaque destinataire est revalidé: il a pu se déconnecter entre-temps.
+void Reactor::_drainInbox() {
+    // Autoriser un nouveau réveil avant de vider: aucun lot ne peut être manqué
+    __atomic_store_n(&_wake_pending, 0, __ATOMIC_SEQ_CST);
+    
+    while (MpscNode* node = _inbox.pop()) {
+        Delivery* delivery = static_cast<Delivery*>(node);
+        for (size_t i = 0; i < delivery->targets.size(); ++i) {
+            const ClientRef& ref = delivery->targets[i];
+            std::map<int, Client*>::iterator it = _clients.find(ref.fd);
+            if (it != _clients.end() && it->second == ref.client && ref.client->getId() == ref.id) {
+                enqueue(ref.client, delivery->messages[i]);
+            }
+        }
+        delete delivery;
+    }
+}
+
+// Vider les files des clients ayant reçu des données pendant l'itération
+// Avec une fenêtre de micro-batching, on attend qu'elle soit écoulée.
+void Reactor::_flushDirtyClients() {
+    if (_dirty_clients.empty()) {
+        return;
+    }
+    int flush_delay_ms = _server->getConfig().flush_delay_ms;
+    if (flush_delay_ms > 0 && monotonicMs() - _dirty_since_ms < flush_delay_ms) {
+        return;
+    }
+    
+    std::vector<Client*> dirty;
+    dirty.swap(_dirty_clients);
+    _send_clients.clear();
+    for (size_t i = 0; i < dirty.size(); ++i) {
+        dirty[i]->setFlushPending(false);
+        if (!dirty[i]->hasWriteInterest() && !dirty[i]->isDisconnected()) {
+            _metrics.sendq_bytes.record(dirty[i]->getSendQueue().size());
+            _send_clients.push_back(dirty[i]);
+        }
+    }
+    
+    // Un lot par tour: un seul appel au moteur pour tous les sockets
+    while (!_send_clients.empty()) {
+        size_t count = _send_clients.size();
+        _send_requests.resize(count);
+        _send_iov.resize(count * SENDQUEUE_MAX_IOV);
+        for (size_t i = 0; i < count; ++i) {
+            SendRequest& request = _send_requests[i];
+            request.fd = _send_clients[i]->getFd();
+            request.iov = &_send_iov[i * SENDQUEUE_MAX_IOV];
+            request.iov_count = _send_clients[i]->getSendQueue().prepare(&_send_iov[i * SENDQUEUE_MAX_IOV],
+                                                                        SENDQUEUE_MAX_IOV, &request.length);
+        }
+        _engine->sendBatch(&_send_requests[0], count);
+        
+        size_t kept = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (_completeSend(_send_clients[i], _send_requests[i])) {
+                _send_clients[kept++] = _send_clients[i];
+            }
+        }
+        _send_clients.resize(kept);
+    }
+}
+
+// Résultat d'un envoi du lot
+// Tout est parti mais la file n'est pas vide (plus de SENDQUEUE_MAX_IOV messages): un tour de plus.
+bool Reactor::_completeSend(Client* client, const SendRequest& request) {
+    if (client->isDisconnected()) {
+        return false;
+    }
+    if (request.result < 0) {
+        if (request.error != EAGAIN && request.error != EWOULDBLOCK && request.error != EINTR) {
+            LOG_ERROR(LOG_NET, "Error sending to client " << client->getFd() 
+                      << ": " << strerror(request.error));
+            disconnectClient(client, "Write error");
+            return false;
+        }
+        _afterFlush(client); // Socket plein: attendre EVENT_WRITE
+        return false;
+    }
+    size_t bytes_sent = request.result;
+    client->getSendQueue().consume(bytes_sent);
+    metricAdd(_metrics.bytes_out, bytes_sent);
+    LOG_DEBUG(LOG_NET, "Sent " << bytes_sent << " bytes to client " << client->getFd());
+    if (bytes_sent == request.length && client->hasPendingData()) {
+        return true;
+    }
+    _afterFlush(client);
+    return false;
+}
+
+// Timeout de wait(): infini, sauf si des envois attendent la fin de la fenêtre,
+// si un timer est armé, si un lot entrant n'était pas encore entièrement publié
+// ou si des objets retirés attendent leur libération
+int Reactor::_computeWaitTimeout() const {
+    if (!_inbox.empty() || !_resume_clients.empty() || _accept_pending) {
+        return 0;
+    }
+    if (_dirty_clients.empty() && _timers.empty() && _retired.empty()) {
+        return -1;
+    }
+    long now_ms = monotonicMs();
+    long timeout = -1;
+    if (!_dirty_clients.empty()) {
+        timeout = _server->getConfig().flush_delay_ms - (now_ms - _dirty_since_ms);
+    }
+    // Prochaine échéance de la roue (keepalive, retour de crédit de flood)
+    long expiry_ms = _timers.nextExpiry();
+    if (expiry_ms >= 0 && (timeout < 0 || expiry_ms - now_ms < timeout)) {
+        timeout = expiry_ms - now_ms;
+    }
+    // Lots retirés: revenir vérifier la période de grâce
+    if (!_retired.empty() && (timeout < 0 || timeout > RECLAIM_POLL_MS)) {
+        timeout = RECLAIM_POLL_MS;
+    }
+    return timeout > 0 ? static_cast<int>(timeout) : 0;
+}
+
+// Vider la file d'envoi d'un client autant que le socket le permet
+void Reactor::_flushClient(Client* client) {
+    if (client->isDisconnected()) {
+        return;
+    }
+    size_t bytes_sent = 0;
+    _metrics.sendq_bytes.record(client->getSendQueue().size());
+    SendQueue::FlushResult result = client->getSendQueue().flush(client->getFd(), &bytes_sent);
+    
+    if (result == SendQueue::FLUSH_ERROR) {
+        LOG_ERROR(LOG_NET, "Error sending to client " << client->getFd() 
+                  << ": " << strerror(errno));
+        disconnectClient(client, "Write error");
+        return;
+    }
+    metricAdd(_metrics.bytes_out, bytes_sent);
+    if (bytes_sent > 0) {
+        LOG_DEBUG(LOG_NET, "Sent " << bytes_sent << " bytes to client " << client->getFd());
+    }
+    _afterFlush(client);
+}
+
+// Après un envoi: reprise de la lecture et intérêts selon la file restante
+void Reactor::_afterFlush(Client* client) {
+    client->updateQueuedBytes();
+    
+    // Reprendre la lecture une fois la file redescendue à la moitié du seuil
+    if (client->isReadSuspended() && client->getSendQueue().size() <= _sendq_soft / 2) {
+        client->setReadSuspended(false);
+        _resume_clients.push_back(client);
+        LOG_DEBUG(LOG_NET, "Resuming reads from client " << client->getFd());
+    }
+    _updateInterest(client);
+}
+
+// Activer la surveillance en écriture uniquement tant que la file n'est pas vide
+void Reactor::_updateInterest(Client* client) {
+    bool wants_write = client->hasPendingData();
+    bool wants_read = !client->isReadSuspended() && !client->getRecvBuffer().full();
+    if (wants_write == client->hasWriteInterest() && wants_read == client->hasReadInterest()) {
+        return;
+    }
+    int interest = (wants_read ? EVENT_READ : 0) | (wants_write ? EVENT_WRITE : 0);
+    if (_engine->modify(client->getFd(), interest, client)) {
+        client->setWriteInterest(wants_write);
+        client->setReadInterest(wants_read);
+    } else {
+        LOG_ERROR(LOG_NET, "Failed to update interest for client " << client->getFd() 
+                  << ": " << strerror(errno));
+    }
+}
+
+// Déconnecter les clients dont la SendQ a dépassé le plafond
+// La file est abandonnée (sauf la fin d'une ligne entamée, pour ne pas la couper);
+// seule la ligne ERROR est tentée, sans attendre.
+// Les QUIT envoyés aux autres membres peuvent en pousser d'autres au-delà: boucler.
+void Reactor::_evictSlowClients() {
+    while (!_slow_clients.empty()) {
+        std::vector<Client*> slow;
+        slow.swap(_slow_clients);
+        for (size_t i = 0; i < slow.size(); ++i) {
+            Client* client = slow[i];
+            if (client->isDisconnected()) {
+                continue;
+            }
+            SendQueue& queue = client->getSendQueue();
+            LOG_WARN(LOG_NET, "Max SendQ exceeded for client " << client->getFd() 
+                     << " (" << queue.size() << " bytes queued)");
+            metricAdd(_metrics.sendq_evictions, 1);
+            queue.clearUnsent();
+            queue.push(SharedBuffer("ERROR :Closing Link: Max SendQ exceeded\r\n"));
+            queue.flush(client->getFd());
+            disconnectClient(client, "Max SendQ exceeded");
+        }
+    }
+}
+
+// Mettre un client en fake lag: ses lignes restent en RecvQ jusqu'au retour du crédit
+void Reactor::_throttleClient(Client* client) {
+    if (client->isFloodThrottled()) {
+        return;
+    }
+    client->setFloodThrottled(true);
+    metricAdd(_metrics.flood_throttles, 1);
+    long wait_ms = client->getFloodBucket().msUntilAvailable(_server->getConfig().flood_rate);
+    _timers.schedule(&client->getFloodTimer(), _now_ms + wait_ms);
+    LOG_DEBUG(LOG_NET, "Flood control: delaying commands from client " << client->getFd());
+}
+
+// Timer de flood échu: reprendre le client si son crédit est redevenu positif
+void Reactor::_releaseThrottledClient(Client* client) {
+    const ServerConfig& config = _server->getConfig();
+    TokenBucket& bucket = client->getFloodBucket();
+    bucket.refill(_now_ms, config.flood_rate, config.flood_burst);
+    if (!bucket.available()) {
+        _timers.schedule(&client->getFloodTimer(), _now_ms + bucket.msUntilAvailable(config.flood_rate));
+        return;
+    }
+    client->setFloodThrottled(false);
+    _resume_clients.push_back(client);
+}
+
+// Aiguiller les timers échus depuis l'itération précédente
+// Un timer réarmé entre-temps (ou dont le client est parti) est ignoré.
+void Reactor::_runTimers() {
+    _timers.advance(_now_ms, _expired_timers);
+    for (size_t i = 0; i < _expired_timers.size(); ++i) {
+        Timer* timer = _expired_timers[i];
+        if (timer == &_accept_sample_timer) {
+            _sampleAcceptQueue();
+            _timers.schedule(timer, _now_ms + ACCEPT_SAMPLE_INTERVAL_MS);
+            continue;
+        }
+        Client* client = static_cast<Client*>(timer->owner);
+        if (timer->armed() || client->isDisconnected()) {
+            continue;
+        }
+        if (timer->type == TIMER_KEEPALIVE) {
+            _checkKeepalive(client);
+        } else {
+            _releaseThrottledClient(client);
+        }
+    }
+    _expired_timers.clear();
+}
+
+// Premier réveil: fin du délai d'enregistrement, sinon première vérification d'inactivité
+void Reactor::_startKeepalive(Client* client) {
+    const ServerConfig& config = _server->getConfig();
+    int delay_s = config.registration_timeout > 0 ? config.registration_timeout : config.ping_interval;
+    if (delay_s > 0) {
+        _timers.schedule(&client->getKeepaliveTimer(), _now_ms + delay_s * 1000L);
+    }
+}
+
+// Un seul timer par client, dont le rôle suit son état:
+// - pas encore enregistré: déconnexion à la fin du délai d'enregistrement;
+// - PING en attente: toute donnée reçue depuis vaut réponse, sinon déconnexion au délai;
+// - sinon: PING après ping_interval sans rien recevoir.
+// Recevoir des données ne touche pas à la roue (un horodatage): l'échéance est
+// recalculée ici, et le timer réarmé sur la dernière activité.
+void Reactor::_checkKeepalive(Client* client) {
+    const ServerConfig& config = _server->getConfig();
+    Timer* timer = &client->getKeepaliveTimer();
+    
+    if (!client->isAuthenticated() && config.registration_timeout > 0) {
+        long deadline_ms = client->getConnectedMs() + config.registration_timeout * 1000L;
+        if (_now_ms < deadline_ms) {
+            _timers.schedule(timer, deadline_ms); // Échéance avancée par la portée de la roue
+            return;
+        }
+        LOG_INFO(LOG_NET, "Registration timeout for client " << client->getFd());
+        metricAdd(_metrics.registration_timeouts, 1);
+        _closeLink(client, "Registration timeout");
+        return;
+    }
+    if (config.ping_interval == 0) {
+        return;
+    }
+    
+    long ping_sent_ms = client->getPingSentMs();
+    if (ping_sent_ms != 0 && client->getLastActiveMs() < ping_sent_ms) {
+        long deadline_ms = ping_sent_ms + config.ping_timeout * 1000L;
+        if (_now_ms < deadline_ms) {
+            _timers.schedule(timer, deadline_ms);
+            return;
+        }
+        LOG_INFO(LOG_NET, "Ping timeout for client " << client->getFd());
+        metricAdd(_metrics.ping_timeouts, 1);
+        _closeLink(client, "Ping timeout: " + intToString((_now_ms - client->getLastActiveMs()) / 1000) + " seconds");
+        return;
+    }
+    client->setPingSentMs(0);
+    
+    long idle_deadline_ms = client->getLastActiveMs() + config.ping_interval * 1000L;
+    if (_now_ms < idle_deadline_ms) {
+        _timers.schedule(timer, idle_deadline_ms);
+        return;
+    }
+    enqueue(client, SharedBuffer("PING :localhost\r\n"));
+    metricAdd(_metrics.pings_sent, 1);
+    client->setPingSentMs(_now_ms);
+    _timers.schedule(timer, _now_ms + config.ping_timeout * 1000L);
+}
+
+// Tenter d'envoyer la ligne ERROR avant de fermer la connexion
+void Reactor::_closeLink(Client* client, const std::string& reason) {
+    enqueue(client, SharedBuffer("ERROR :Closing Link: " + reason + "\r\n"));
+    _flushClient(client);
+    disconnectClient(client, reason);
+}
+
+// Reprendre les clients dont la lecture était suspendue (SendQ ou flood)
+// Les lignes restées en RecvQ sont traitées, puis le socket est lu jusqu'à EAGAIN.
+void Reactor::_resumeClients() {
+    std::vector<Client*> resumed;
+    resumed.swap(_resume_clients);
+    for (size_t i = 0; i < resumed.size(); ++i) {
+        Client* client = resumed[i];
+        if (!client->isDisconnected() && !client->isReadSuspended()) {
+            _handleClientData(client);
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#include "RecvBuffer.hpp"
+#include <cstring>
+
+RecvBuffer::RecvBuffer(size_t capacity) 
+    : _buffer(NULL), _capacity(IRC_MAX_LINE), _mask(0), _head(0), _tail(0), _scan(0), _discarding(false) {
+    while (_capacity < capacity) {
+        _capacity <<= 1;
+    }
+    _mask = _capacity - 1;
+    _buffer = new char[_capacity];
+}
+
+RecvBuffer::~RecvBuffer() {
+    delete[] _buffer;
+}
+
+// Zones libres: de _tail jusqu'à la fin physique, puis depuis le début jusqu'à _head
+int RecvBuffer::writableRegions(struct iovec iov[2]) {
+    size_t free_bytes = _capacity - size();
+    if (free_bytes == 0) {
+        return 0;
+    }
+    size_t start = _tail & _mask;
+    size_t first = _capacity - start;
+    if (first >= free_bytes) {
+        iov[0].iov_base = _buffer + start;
+        iov[0].iov_len = free_bytes;
+        return 1;
+    }
+    iov[0].iov_base = _buffer + start;
+    iov[0].iov_len = first;
+    iov[1].iov_base = _buffer;
+    iov[1].iov_len = free_bytes - first;
+    return 2;
+}
+
+void RecvBuffer::commit(size_t bytes) {
+    _tail += bytes;
+}
+
+// Chercher '\n' entre _scan et _tail, sans jamais réexplorer les mêmes octets
+bool RecvBuffer::_findNewline(size_t& pos) {
+    while (_scan < _tail) {
+        size_t start = _scan & _mask;
+        size_t len = _tail - _scan;
+        if (start + len > _capacity) {
+            len = _capacity - start; // S'arrêter à la fin physique du buffer
+        }
+        const char* found = static_cast<const char*>(std::memchr(_buffer + start, '\n', len));
+        if (found != NULL) {
+            pos = _scan + (found - (_buffer + start));
+            return true;
+        }
+        _scan += len;
+    }
+    return false;
+}
+
+// Extraire la prochaine ligne complète
+RecvBuffer::LineStatus RecvBuffer::nextLine(StringRef& line) {
+    size_t pos;
+
+    // Fin d'une ligne trop longue déjà signalée: tout ignorer jusqu'au '\n'
+    if (_discarding) {
+        if (!_findNewline(pos)) {
+            _head = _scan = _tail;
+            return LINE_NONE;
+        }
+        _head = _scan = pos + 1;
+        _discarding = false;
+    }
+
+    if (!_findNewline(pos)) {
+        if (size() >= IRC_MAX_LINE) {
+            _discarding = true;
+            _head = _scan = _tail;
+            return LINE_TOO_LONG;
+        }
+        return LINE_NONE;
+    }
+
+    size_t len = pos - _head;
+    if (len + 1 > IRC_MAX_LINE) {
+        _head = _scan = pos + 1;
+        return LINE_TOO_LONG;
+    }
+
+    // Ligne contiguë: vue directe; sinon recopie dans _scratch (au plus 511 octets)
+    size_t start = _head & _mask;
+    const char* data;
+    if (start + len <= _capacity) {
+        data = _buffer + start;
+    } else {
+        size_t first = _capacity - start;
+        std::memcpy(_scratch, _buffer + start, first);
+        std::memcpy(_scratch + first, _buffer, len - first);
+        data = _scratch;
+    }
+    if (len > 0 && data[len - 1] == '\r') {
+        --len;
+    }
+
+    line = StringRef(data, len);
+    _head = _scan = pos + 1;
+    return LINE_OK;
+}
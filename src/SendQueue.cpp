@@ -0,0 +1,113 @@
+#include "SendQueue.hpp"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <cerrno>
+#include <cstring>
+
+SendQueue::SendQueue() : _offset(0), _bytes(0) {
+}
+
+// Ajouter une référence au message en fin de file (aucune copie des octets)
+void SendQueue::push(const SharedBuffer& message) {
+    if (message.empty()) {
+        return;
+    }
+    _chunks.push_back(message);
+    _bytes += message.size();
+}
+
+// Copier à la fin du dernier bloc s'il est privé et a la place, sinon dans un nouveau bloc
+// Une rafale de réponses ne coûte qu'une allocation par SENDQUEUE_APPEND_BLOCK octets.
+void SendQueue::append(const char* data, size_t length) {
+    if (length == 0) {
+        return;
+    }
+    if (_chunks.empty() || !_chunks.back().tryAppend(data, length)) {
+        _chunks.push_back(SharedBuffer::reserve(length > SENDQUEUE_APPEND_BLOCK ? length : SENDQUEUE_APPEND_BLOCK));
+        _chunks.back().tryAppend(data, length);
+    }
+    _bytes += length;
+}
+
+// Vider la file sans rien envoyer
+void SendQueue::clear() {
+    _chunks.clear();
+    _offset = 0;
+    _bytes = 0;
+}
+
+// Abandonner la file sans couper de ligne: un premier message partiellement envoyé
+// est gardé (sa partie restante), seuls les messages suivants sont retirés.
+void SendQueue::clearUnsent() {
+    if (_offset == 0) {
+        clear();
+        return;
+    }
+    _chunks.resize(1);
+    _bytes = _chunks.front().size() - _offset;
+}
+
+// Segments des premiers messages, le premier privé de sa partie déjà envoyée
+int SendQueue::prepare(struct iovec* iov, int max_count, size_t* length) const {
+    int count = 0;
+    size_t total = 0;
+    for (std::deque<SharedBuffer>::const_iterator it = _chunks.begin();
+         it != _chunks.end() && count < max_count; ++it, ++count) {
+        size_t skip = (count == 0) ? _offset : 0;
+        iov[count].iov_base = const_cast<char*>(it->data() + skip);
+        iov[count].iov_len = it->size() - skip;
+        total += iov[count].iov_len;
+    }
+    if (length) *length = total;
+    return count;
+}
+
+// Retirer les messages entièrement envoyés
+void SendQueue::consume(size_t sent) {
+    _bytes -= sent;
+    while (sent > 0) {
+        size_t left_in_front = _chunks.front().size() - _offset;
+        if (sent < left_in_front) {
+            _offset += sent;
+            return;
+        }
+        sent -= left_in_front;
+        _chunks.pop_front();
+        _offset = 0;
+    }
+}
+
+// Envoyer jusqu'à vider la file ou jusqu'à EAGAIN
+// Chaque appel système couvre jusqu'à SENDQUEUE_MAX_IOV messages.
+SendQueue::FlushResult SendQueue::flush(int fd, size_t* bytes_sent) {
+    size_t total = 0;
+    struct iovec iov[SENDQUEUE_MAX_IOV];
+
+    while (!_chunks.empty()) {
+        int count = prepare(iov, SENDQUEUE_MAX_IOV, NULL);
+
+        // sendmsg() plutôt que writev() pour MSG_NOSIGNAL (pas de SIGPIPE)
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (bytes_sent) *bytes_sent = total;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FLUSH_PARTIAL;
+            }
+            return FLUSH_ERROR;
+        }
+
+        total += sent;
+        consume(sent);
+    }
+
+    if (bytes_sent) *bytes_sent = total;
+    return FLUSH_DONE;
+}
@@ -1,393 +1,441 @@
 #include "Server.hpp"
+#include "Reactor.hpp"
+#include "MetricsExporter.hpp"
 #include "Client.hpp"
 #include "Channel.hpp"
-#include "commands/AuthCommands.hpp"
-#include "commands/ChannelCommands.hpp"
-#include "commands/MessageCommands.hpp"
+#include "IrcMessage.hpp"
+#include "CommandTable.hpp"
+#include "LockGuard.hpp"
+#include "Logger.hpp"
 #include <stdexcept>
-#include <cstring>    // pour strerror
-#include <cerrno>     // pour errno
+#include <algorithm>
+#include <cctype>
+#include <new>        // pour le placement new
 #include "utils.hpp"  // pour intToString
 
+// Ordre des verrous de l'état partagé (jamais l'inverse):
+//   channel -> part de _channels -> _channel_pool_lock, verrou de HistoryStore
+//   channel -> part de _nicknames, liens d'un client (Client::_membership_lock)
+// Ces deux derniers ne prennent aucun autre verrou; un changement de nickname prend
+// deux parts de _nicknames, par adresse croissante. Aucun envoi sous un verrou: les
+// destinataires sont relevés sous celui du channel, puis servis par deliver().
+
 // Constructeur : initialise le serveur avec port et password
-Server::Server(int port, const std::string& password) 
-    : _port(port), _password(password), _server_fd(-1), _running(false) {
-    
-    std::cout << "Initializing IRC Server..." << std::endl;
+// Chaque shard ouvre son propre listener SO_REUSEPORT sur le même port.
+Server::Server(int port, const std::string& password, const ServerConfig& config) 
+    : _port(port), _password(password), _config(config), _metrics_exporter(NULL), 
+      _channel_pool(config.max_channels), _history(config), _channel_count(0), _client_count(0), _listen_overflows(0), _start_ms(monotonicMs()), _running(0) {
     
-    // Initialiser la structure d'adresse à zéro
-    std::memset(&_server_addr, 0, sizeof(_server_addr));
+    LOG_INFO(LOG_SERVER, "Initializing IRC Server...");
+    pthread_mutex_init(&_channel_pool_lock, NULL);
     
     try {
-        _setupSocket();     // Créer et configurer le socket
-        _bindAndListen();   // Bind sur le port et mettre en écoute
+        for (int i = 0; i < _config.threads; ++i) {
+            _reactors.push_back(new Reactor(this, i));
+            _reactors.back()->open();
+        }
+        if (_config.metrics_port > 0) {
+            _metrics_exporter = new MetricsExporter(this, _config.metrics_port);
+        }
+        LOG_INFO(LOG_SERVER, "Using " << _config.threads << " reactor(s) with " 
+                  << _reactors[0]->getEngineName() << " event engine");
         
-        std::cout << "Server initialized successfully on port " << _port << std::endl;
+        LOG_INFO(LOG_SERVER, "Server initialized successfully on port " << _port);
         
     } catch (const std::exception& e) {
         // En cas d'erreur, nettoyer et relancer l'exception
-        if (_server_fd != -1) {
-            close(_server_fd);
-            _server_fd = -1;
+        delete _metrics_exporter;
+        for (size_t i = 0; i < _reactors.size(); ++i) {
+            delete _reactors[i];
         }
+        _reactors.clear();
+        pthread_mutex_destroy(&_channel_pool_lock);
         throw; // Relancer l'exception
     }
 }
 
 // Destructeur : nettoyer toutes les ressources
 Server::~Server() {
-    std::cout << "Shutting down IRC Server..." << std::endl;
+    LOG_INFO(LOG_SERVER, "Shutting down IRC Server...");
     
-    // Déconnecter tous les clients
-    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        delete it->second;  // Supprimer l'objet Client
-        close(it->first);   // Fermer le socket
-    }
-    _clients.clear();
-    
-    // Supprimer tous les channels
-    for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it) {
-        delete it->second;
-    }
+    // Supprimer tous les channels (détache les liens côté client)
+    std::vector<Channel*> channels;
+    _channels.values(channels);
     _channels.clear();
-    
-    // Fermer le socket serveur
-    if (_server_fd != -1) {
-        close(_server_fd);
-    }
-    
-    std::cout << "Server shutdown complete" << std::endl;
-}
-
-// Créer et configurer le socket serveur
-void Server::_setupSocket() {
-    // Créer un socket TCP IPv4
-    _server_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (_server_fd < 0) {
-        throw std::runtime_error("Failed to create socket: " + std::string(strerror(errno)));
-    }
-    
-    // Option SO_REUSEADDR : permet de réutiliser l'adresse immédiatement
-    int opt = 1;
-    if (setsockopt(_server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        throw std::runtime_error("Failed to set SO_REUSEADDR: " + std::string(strerror(errno)));
+    for (size_t i = 0; i < channels.size(); ++i) {
+        _history.release(channels[i]->getHistory());
+        _channel_pool.destroy(channels[i]);
     }
+    delete _metrics_exporter;
     
-    // Configurer le socket en mode non-bloquant
-    if (fcntl(_server_fd, F_SETFL, O_NONBLOCK) < 0) {
-        throw std::runtime_error("Failed to set non-blocking mode: " + std::string(strerror(errno)));
+    // Déconnecter tous les clients et fermer les sockets de chaque shard
+    // (libère aussi les clients et channels encore en période de grâce)
+    for (size_t i = 0; i < _reactors.size(); ++i) {
+        delete _reactors[i];
     }
+    _reactors.clear();
+    pthread_mutex_destroy(&_channel_pool_lock);
     
-    std::cout << "Socket created and configured" << std::endl;
+    LOG_INFO(LOG_SERVER, "Server shutdown complete");
 }
 
-// Associer le socket à une adresse et mettre en écoute
-void Server::_bindAndListen() {
-    // Configurer l'adresse du serveur
-    _server_addr.sin_family = AF_INET;         // IPv4
-    _server_addr.sin_addr.s_addr = INADDR_ANY; // Écouter sur toutes les interfaces
-    _server_addr.sin_port = htons(_port);      // Port en format réseau (big-endian)
-    
-    // Associer le socket à l'adresse
-    if (bind(_server_fd, (struct sockaddr*)&_server_addr, sizeof(_server_addr)) < 0) {
-        throw std::runtime_error("Failed to bind to port " + intToString(_port) + ": " + std::string(strerror(errno)));
-    }
-    
-    // Mettre le socket en mode écoute
-    if (listen(_server_fd, 10) < 0) {
-        throw std::runtime_error("Failed to listen on socket: " + std::string(strerror(errno)));
-    }
-    
-    std::cout << "Server bound and listening on port " << _port << std::endl;
-}
-
-// Démarrer le serveur et entrer dans la boucle principale
+// Démarrer le serveur: un thread par shard supplémentaire, le premier tourne ici
 void Server::start() {
-    std::cout << "Starting IRC Server main loop..." << std::endl;
+    LOG_INFO(LOG_SERVER, "Starting IRC Server main loop...");
     
-    _running = true;
-    
-    // Ajouter le socket serveur à la liste de surveillance poll()
-    _addToPoll(_server_fd, POLLIN);
+    __atomic_store_n(&_running, 1, __ATOMIC_RELEASE);
     
     try {
-        _runEventLoop(); // Boucle principale
+        if (_metrics_exporter != NULL) {
+            _metrics_exporter->startThread();
+        }
+        for (size_t i = 1; i < _reactors.size(); ++i) {
+            _reactors[i]->startThread();
+        }
+        _reactors[0]->run(); // Boucle principale
     } catch (const std::exception& e) {
-        std::cerr << "Error in main loop: " << e.what() << std::endl;
+        LOG_ERROR(LOG_SERVER, "Error in main loop: " << e.what());
         stop();
+        _joinThreads();
         throw;
     }
+    _joinThreads();
+}
+
+// Attendre la fin des threads lancés par start()
+void Server::_joinThreads() {
+    for (size_t i = 1; i < _reactors.size(); ++i) {
+        _reactors[i]->join();
+    }
+    if (_metrics_exporter != NULL) {
+        _metrics_exporter->join();
+    }
 }
 
-// Arrêter le serveur
+// Arrêter le serveur (thread-safe): chaque boucle est réveillée pour le constater
 void Server::stop() {
-    std::cout << "Stopping server..." << std::endl;
-    _running = false;
+    LOG_INFO(LOG_SERVER, "Stopping server...");
+    __atomic_store_n(&_running, 0, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < _reactors.size(); ++i) {
+        _reactors[i]->wake();
+    }
 }
 
-// Boucle principale du serveur avec poll()
-void Server::_runEventLoop() {
-    while (_running) {
-        // poll() surveille tous les file descriptors et attend des événements
-        int poll_result = poll(&_poll_fds[0], _poll_fds.size(), -1);
-        
-        if (poll_result < 0) {
-            if (errno == EINTR) {
-                continue; // Interrompu par un signal (normal), continuer
-            }
-            throw std::runtime_error("poll() failed: " + std::string(strerror(errno)));
-        }
-        
-        // Parcourir tous les file descriptors pour voir lesquels ont des événements
-        for (size_t i = 0; i < _poll_fds.size(); ++i) {
-            
-            // Vérifier s'il y a des événements sur ce FD
-            if (_poll_fds[i].revents == 0) {
-                continue; // Pas d'événements, passer au suivant
-            }
-            
-            // Le serveur (toujours à l'index 0) a une nouvelle connexion
-            if (_poll_fds[i].fd == _server_fd && (_poll_fds[i].revents & POLLIN)) {
-                _acceptNewClient();
-            }
-            // Un client existant a envoyé des données
-            else if (_poll_fds[i].revents & POLLIN) {
-                _handleClientData(_poll_fds[i].fd);
-            }
-            // Erreur sur un socket (connexion fermée, etc.)
-            else if (_poll_fds[i].revents & (POLLHUP | POLLERR | POLLNVAL)) {
-                std::cout << "Client disconnected (socket error)" << std::endl;
-                _disconnectClient(_poll_fds[i].fd);
-                --i; // Ajuster l'index car on a supprimé un élément
-            }
-        }
+// Retirer un client de l'état partagé avant sa fermeture par son reactor
+// Les autres reactors peuvent encore le tenir jusqu'à la fin de leur itération:
+// il n'est libéré qu'après (Reactor::_reclaim), et ne reçoit plus rien.
+void Server::_detachClient(Client* client, const std::string& reason) {
+    // Quitter tous les channels avant que le Client ne devienne invalide
+    _leaveAllChannels(client, reason);
+    
+    if (!client->getNickname().empty()) {
+        _nicknames.erase(client->getNickname(), client);
     }
+    client->markDisconnected();
 }
 
-// Accepter une nouvelle connexion client
-void Server::_acceptNewClient() {
-    struct sockaddr_in client_addr;
-    socklen_t client_len = sizeof(client_addr);
-    
-    // Accepter la connexion
-    int client_fd = accept(_server_fd, (struct sockaddr*)&client_addr, &client_len);
-    
-    if (client_fd < 0) {
-        if (errno != EWOULDBLOCK && errno != EAGAIN) {
-            std::cerr << "Failed to accept client: " << strerror(errno) << std::endl;
+// Détacher chaque lien sous le verrou de son channel, puis prévenir les autres
+// membres (une seule fois chacun) hors de tout verrou
+// O(channels rejoints): les liens sont parcourus directement, sans recherche par nom.
+void Server::_leaveAllChannels(Client* client, const std::string& reason) {
+    std::vector<Client*>& recipients = Reactor::current()->getRecipients();
+    while (Channel* channel = client->nextChannel()) {
+        LockGuard guard(channel->getLock());
+        Membership* membership = channel->findMembership(client);
+        if (membership == NULL) {
+            continue; // Kické entre-temps depuis un autre shard
+        }
+        channel->collectMembers(recipients, client);
+        channel->removeMembership(membership);
+        if (channel->isEmpty()) {
+            _retireChannel(channel);
         }
-        return; // Pas d'erreur fatale, continuer
     }
-    
-    // Configurer le socket client en mode non-bloquant
-    if (fcntl(client_fd, F_SETFL, O_NONBLOCK) < 0) {
-        std::cerr << "Failed to set client socket non-blocking: " << strerror(errno) << std::endl;
-        close(client_fd);
+    if (recipients.empty()) {
         return;
     }
     
-    // Récupérer l'adresse IP du client
-    std::string client_ip = inet_ntoa(client_addr.sin_addr);
-    
-    // Créer un objet Client pour ce nouveau client
-    Client* new_client = new Client(client_fd, client_ip);
-    
-    // Ajouter le client à nos structures de données
-    _clients[client_fd] = new_client;
-    _addToPoll(client_fd, POLLIN);
-    
-    std::cout << "New client connected from " << client_ip 
-              << " (fd: " << client_fd << ")" << std::endl;
+    std::sort(recipients.begin(), recipients.end());
+    recipients.erase(std::unique(recipients.begin(), recipients.end()), recipients.end());
+    LineBuilder line(Reactor::current()->getArena());
+    line << client->getPrefix() << " QUIT :" << reason << "\r\n";
+    deliver(recipients, line.ref());
 }
 
-// Traiter les données reçues d'un client
-void Server::_handleClientData(int client_fd) {
-    // Vérifier que le client existe
-    std::map<int, Client*>::iterator it = _clients.find(client_fd);
-    if (it == _clients.end()) {
-        std::cerr << "Received data from unknown client fd: " << client_fd << std::endl;
-        return;
+// Parser les commandes IRC reçues et les aiguiller via la table des commandes
+// Les vérifications communes (enregistrement, nombre de paramètres) sont faites ici.
+// Aucun verrou global: chaque handler verrouille le channel ou la part d'index qu'il touche.
+// Retourne le coût de la ligne pour le contrôle de flood (1 hors commandes connues).
+int Server::_parseCommand(Client* client, const StringRef& line) {
+    IrcMessage msg;
+    if (!IrcMessage::parse(line, msg)) {
+        return 1;
     }
     
-    Client* client = it->second;
-    char buffer[1024];
+    LOG_DEBUG(LOG_CMD, "Command: '" << msg.command << "', Params: " << msg.param_count);
     
-    // Recevoir les données
-    ssize_t bytes_received = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytes_received <= 0) {
-        if (bytes_received == 0) {
-            std::cout << "Client " << client_fd << " disconnected" << std::endl;
-        } else {
-            std::cerr << "Error receiving from client " << client_fd 
-                      << ": " << strerror(errno) << std::endl;
-        }
-        _disconnectClient(client_fd);
-        return;
+    const CommandInfo* command = CommandTable::lookup(msg.command);
+    Reactor* reactor = Reactor::current();
+    Metrics& metrics = reactor->getMetrics();
+    if (command == NULL) {
+        metricAdd(metrics.commands[METRICS_UNKNOWN_COMMAND], 1);
+        LOG_DEBUG(LOG_CMD, "Unknown command: " << msg.command);
+        sendNumeric(client, ERR_UNKNOWNCOMMAND, msg.command);
+        return 1;
     }
     
-    // Terminer la chaîne et l'ajouter au buffer du client
-    buffer[bytes_received] = '\0';
-    client->appendToReceiveBuffer(std::string(buffer));
+    if (command->requires_registration && !client->isAuthenticated()) {
+        sendNumeric(client, ERR_NOTREGISTERED);
+        return command->flood_cost;
+    }
+    if (msg.param_count < command->min_params) {
+        sendNumeric(client, ERR_NEEDMOREPARAMS, command->name);
+        return command->flood_cost;
+    }
     
-    // Traiter tous les messages complets disponibles
-    while (client->hasCompleteMessage()) {
-        std::string message = client->extractMessage();
-        std::cout << "Received from " << client_fd << ": " << message << std::endl;
-        
-        // Parser et traiter la commande IRC
-        _parseCommand(client, message);
+    long long started_ns = monotonicNs();
+    command->handler(this, client, msg);
+    metricAdd(metrics.commands[command->id], 1);
+    metrics.command_ns[command->id].record(monotonicNs() - started_ns);
+    return command->flood_cost;
+}
+
+// Envoyer une réponse à un client
+// Sur le shard du client, la réponse est copiée directement dans sa SendQ
+void Server::sendResponse(Client* client, const StringRef& response) {
+    if (client->isDisconnected()) {
+        return;
+    }
+    _countErrorReply(response);
+    Reactor* current = Reactor::current();
+    if (current == client->getReactor()) {
+        LOG_DEBUG(LOG_NET, "Sending to client " << client->getFd() << ": " 
+                  << StringRef(response.data, response.length - 2)); // Sans CRLF
+        current->enqueue(client, response.data, response.length);
+    } else {
+        sendMessage(client, SharedBuffer(response.data, response.length));
     }
 }
 
-// Déconnecter un client
-void Server::_disconnectClient(int client_fd) {
-    // Trouver le client
-    std::map<int, Client*>::iterator it = _clients.find(client_fd);
-    if (it != _clients.end()) {
-        delete it->second;      // Supprimer l'objet Client
-        _clients.erase(it);     // Supprimer de la map
+// Réponse numérique formatée sur la pile, adressée au nickname du client ("*" avant NICK)
+void Server::sendNumeric(Client* client, NumericId id, const StringRef& arg1, const StringRef& arg2,
+                         const StringRef& arg3) {
+    StringRef target = client->getNickname().empty() ? StringRef("*") : StringRef(client->getNickname());
+    NumericReply reply(id, target, arg1, arg2, arg3);
+    sendResponse(client, reply.ref());
+}
+
+// Réserver une place parmi max-clients, quel que soit le shard qui accepte
+// Le noyau répartit inégalement les connexions entre listeners SO_REUSEPORT:
+// la limite est globale, jamais une part fixe par shard.
+bool Server::_reserveClient() {
+    int count = __atomic_add_fetch(&_client_count, 1, __ATOMIC_RELAXED);
+    if (_config.max_clients > 0 && count > _config.max_clients) {
+        __atomic_sub_fetch(&_client_count, 1, __ATOMIC_RELAXED);
+        return false;
     }
-    
-    // Supprimer de poll() et fermer le socket
-    _removeFromPoll(client_fd);
-    close(client_fd);
-    
-    std::cout << "Client " << client_fd << " fully disconnected" << std::endl;
+    return true;
 }
 
-// Ajouter un file descriptor à la surveillance poll()
-void Server::_addToPoll(int fd, short events) {
-    struct pollfd pfd;
-    pfd.fd = fd;
-    pfd.events = events;
-    pfd.revents = 0;
-    
-    _poll_fds.push_back(pfd);
+void Server::_releaseClient() {
+    __atomic_sub_fetch(&_client_count, 1, __ATOMIC_RELAXED);
 }
 
-// Supprimer un file descriptor de la surveillance poll()
-void Server::_removeFromPoll(int fd) {
-    for (std::vector<struct pollfd>::iterator it = _poll_fds.begin(); it != _poll_fds.end(); ++it) {
-        if (it->fd == fd) {
-            _poll_fds.erase(it);
-            break;
-        }
+// Compter les réponses d'erreur (4xx/5xx) par numérique
+void Server::_countErrorReply(const StringRef& response) {
+    if (response.length < 4 || (response[0] != '4' && response[0] != '5') || response[3] != ' ' ||
+        !std::isdigit(response[1]) || !std::isdigit(response[2])) {
+        return;
+    }
+    int numeric = (response[0] - '0') * 100 + (response[1] - '0') * 10 + (response[2] - '0');
+    Reactor* current = Reactor::current();
+    if (current != NULL) {
+        metricAdd(current->getMetrics().numerics[numeric - METRICS_NUMERIC_MIN], 1);
+    }
+}
+
+// Agréger les compteurs de tous les reactors (lecture sans verrou)
+void Server::collectMetrics(MetricsSnapshot& snapshot) const {
+    for (size_t i = 0; i < _reactors.size(); ++i) {
+        snapshot.totals.accumulate(_reactors[i]->getMetrics());
     }
+    snapshot.channels = metricRead(_channel_count);
+    snapshot.history_bytes = _history.bytes();
+    snapshot.history_evictions = _history.evictions();
+    snapshot.listen_overflows = metricRead(_listen_overflows); // Jamais /proc ici (STATS, exporteur)
+    snapshot.uptime_s = (monotonicMs() - _start_ms) / 1000;
+    snapshot.reactors = _reactors.size();
 }
 
-// Parser les commandes IRC reçues
-void Server::_parseCommand(Client* client, const std::string& message) {
-    if (message.empty()) {
+// Mettre en file un message déjà encodé (partagé)
+// Point d'entrée unique de toutes les sorties: directement si le client appartient
+// au shard courant, sinon via la boîte de réception de son shard.
+void Server::sendMessage(Client* client, const SharedBuffer& message) {
+    if (client->isDisconnected()) {
         return;
     }
+    LOG_DEBUG(LOG_NET, "Sending to client " << client->getFd() << ": " 
+              << StringRef(message.data(), message.size() - 2)); // Sans CRLF
     
-    std::cout << "Parsing command: '" << message << "'" << std::endl;
-    
-    // Séparer la commande des arguments
-    size_t space_pos = message.find(' ');
-    std::string command;
-    std::string args;
-    
-    if (space_pos != std::string::npos) {
-        command = message.substr(0, space_pos);
-        args = message.substr(space_pos + 1);
+    Reactor* current = Reactor::current();
+    if (current == client->getReactor()) {
+        current->enqueue(client, message);
     } else {
-        command = message;
-        args = "";
+        current->route(client, message);
     }
-    
-    // Convertir en majuscules pour la comparaison
-    for (size_t i = 0; i < command.length(); ++i) {
-        if (command[i] >= 'a' && command[i] <= 'z') {
-            command[i] = command[i] - 'a' + 'A';
-        }
+}
+
+// Diffuser une ligne aux destinataires relevés sous le verrou d'un channel (déjà relâché)
+void Server::deliver(const std::vector<Client*>& recipients, const StringRef& message) {
+    if (!recipients.empty()) {
+        // Encoder une seule fois: chaque membre ne reçoit qu'une référence
+        deliver(recipients, SharedBuffer(message.data, message.length));
     }
-    
-    std::cout << "Command: '" << command << "', Args: '" << args << "'" << std::endl;
-    
-    // Traiter les différentes commandes
-    if (command == "PASS") {
-        AuthCommands::handlePass(this, client, args);
-    } else if (command == "NICK") {
-        AuthCommands::handleNick(this, client, args);
-    } else if (command == "USER") {
-        AuthCommands::handleUser(this, client, args);
-    } else if (command == "JOIN") {
-        ChannelCommands::handleJoin(this, client, args);
-    } else if (command == "PRIVMSG") {
-        MessageCommands::handlePrivmsg(this, client, args);
-    } else if (command == "KICK") {
-        ChannelCommands::handleKick(this, client, args);
-    } else if (command == "INVITE") {
-        ChannelCommands::handleInvite(this, client, args);
-    } else if (command == "TOPIC") {
-        ChannelCommands::handleTopic(this, client, args);
-    } else if (command == "MODE") {
-        ChannelCommands::handleMode(this, client, args);
-    } else {
-        std::cout << "Unknown command: " << command << std::endl;
-        sendResponse(client, "421 * " + command + " :Unknown command\r\n");
+}
+
+void Server::deliver(const std::vector<Client*>& recipients, const SharedBuffer& message) {
+    for (size_t i = 0; i < recipients.size(); ++i) {
+        sendMessage(recipients[i], message);
     }
 }
 
-// Envoyer une réponse à un client
-void Server::sendResponse(Client* client, const std::string& response) {
-    std::cout << "Sending to client " << client->getFd() << ": " << response;
+// Chercher un channel existant (ne crée jamais rien)
+// Non verrouillé: à passer par lockChannel avant de toucher à son état.
+Channel* Server::findChannel(const StringRef& name) {
+    return _channels.find(name);
+}
+
+// Créer un channel (seul JOIN crée: les autres commandes se contentent de findChannel)
+// Sous le verrou de sa part d'index: deux JOIN simultanés obtiennent le même channel,
+// et l'historique d'un channel du même nom vidé juste avant est toujours repris.
+Channel* Server::createChannel(const std::string& name) {
+    ShardedCaseMap<Channel*>::Shard& shard = _channels.shardFor(name);
+    LockGuard guard(&shard.lock);
+    Channel** existing = shard.map.find(name);
+    if (existing != NULL) {
+        return *existing;
+    }
     
-    // Ajouter la réponse au buffer d'envoi du client
-    client->appendToSendBuffer(response);
+    void* slot;
+    {
+        LockGuard pool_guard(&_channel_pool_lock);
+        slot = _channel_pool.allocate();
+    }
+    if (slot == NULL) {
+        LOG_WARN(LOG_CHAN, "Channel limit reached, cannot create " << name);
+        return NULL;
+    }
+    Channel* new_channel = new (slot) Channel(name);
+    shard.map.insert(name, new_channel);
+    __atomic_add_fetch(&_channel_count, 1, __ATOMIC_RELAXED);
+    _history.restore(name, new_channel->getHistory()); // Recréé après s'être vidé
     
-    // Essayer d'envoyer immédiatement
-    const std::string& send_buffer = client->getSendBuffer();
-    if (!send_buffer.empty()) {
-        ssize_t bytes_sent = send(client->getFd(), send_buffer.c_str(), send_buffer.length(), 0);
-        
-        if (bytes_sent > 0) {
-            client->clearSendBuffer(bytes_sent);
-            std::cout << "Sent " << bytes_sent << " bytes to client " << client->getFd() << std::endl;
-        } else if (bytes_sent < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
-            std::cerr << "Error sending to client " << client->getFd() 
-                      << ": " << strerror(errno) << std::endl;
+    LOG_INFO(LOG_CHAN, "Created new channel: " << name);
+    return new_channel;
+}
+
+// Trouver (ou créer) le channel et prendre son verrou; NULL si absent ou si
+// max-channels est atteint. Un channel vidé entre la recherche et le verrou a été
+// retiré de l'index: on recommence (JOIN le recrée).
+Channel* Server::lockChannel(const StringRef& name, bool create) {
+    for (;;) {
+        Channel* channel = findChannel(name);
+        if (channel == NULL && create) {
+            channel = createChannel(name.str());
+        }
+        if (channel == NULL) {
+            return NULL;
         }
+        pthread_mutex_lock(channel->getLock());
+        if (!channel->isDead()) {
+            return channel;
+        }
+        pthread_mutex_unlock(channel->getLock());
     }
 }
 
-// Obtenir ou créer un channel
-Channel* Server::getOrCreateChannel(const std::string& name) {
-    std::map<std::string, Channel*>::iterator it = _channels.find(name);
-    
-    if (it != _channels.end()) {
-        return it->second; // Channel existe déjà
+// Retirer un client d'un channel (sous son verrou), et supprimer le channel s'il devient vide
+void Server::removeFromChannel(Channel* channel, Client* client) {
+    Membership* membership = channel->findMembership(client);
+    if (membership == NULL) {
+        return;
+    }
+    channel->removeMembership(membership);
+    if (channel->isEmpty()) {
+        _retireChannel(channel);
     }
-    
-    // Créer un nouveau channel
-    Channel* new_channel = new Channel(name);
-    _channels[name] = new_channel;
-    
-    std::cout << "Created new channel: " << name << std::endl;
-    return new_channel;
 }
 
-// Supprimer un channel vide
-void Server::removeEmptyChannel(const std::string& name) {
-    std::map<std::string, Channel*>::iterator it = _channels.find(name);
-    
-    if (it != _channels.end() && it->second->isEmpty()) {
-        delete it->second;
-        _channels.erase(it);
-        std::cout << "Removed empty channel: " << name << std::endl;
+// Retirer de l'index un channel vidé; les reactors qui l'ont trouvé juste avant le
+// voient mort sous son verrou, il n'est libéré qu'après leur itération
+void Server::_retireChannel(Channel* channel) {
+    channel->markDead();
+    {
+        ShardedCaseMap<Channel*>::Shard& shard = _channels.shardFor(channel->getName());
+        LockGuard guard(&shard.lock);
+        shard.map.erase(channel->getName());
+        // Sous le verrou que prend createChannel: une recréation reprend cet historique
+        _history.retire(channel->getName(), channel->getHistory());
     }
+    __atomic_sub_fetch(&_channel_count, 1, __ATOMIC_RELAXED);
+    LOG_INFO(LOG_CHAN, "Removed empty channel: " << channel->getName());
+    Reactor::current()->retire(channel);
 }
 
-// Trouver un client par son nickname
-Client* Server::findClientByNickname(const std::string& nickname) {
-    // Parcourir tous les clients connectés
-    for (std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
-        Client* client = it->second;
-        if (client->getNickname() == nickname) {
-            return client;
+// Rendre la case d'un channel retiré (période de grâce écoulée)
+void Server::_destroyChannel(Channel* channel) {
+    LockGuard guard(&_channel_pool_lock);
+    _channel_pool.destroy(channel);
+}
+
+// Lister les clients enregistrés (hors chemin critique: STATS)
+// Un nickname ne change que sous le verrou de sa part, le username plus du tout
+// après l'enregistrement: la copie faite sous ce verrou est cohérente.
+void Server::listClients(std::vector<ClientSummary>& out) {
+    std::vector<Client*> clients;
+    for (size_t i = 0; i < _nicknames.shardCount(); ++i) {
+        ShardedCaseMap<Client*>::Shard& shard = _nicknames.shard(i);
+        LockGuard guard(&shard.lock);
+        clients.clear();
+        shard.map.values(clients);
+        for (size_t j = 0; j < clients.size(); ++j) {
+            if (!clients[j]->isAuthenticated()) {
+                continue;
+            }
+            ClientSummary summary;
+            summary.nickname = clients[j]->getNickname();
+            summary.username = clients[j]->getUsername();
+            summary.hostname = clients[j]->getHostname();
+            summary.client = clients[j];
+            out.push_back(summary);
         }
     }
-    return NULL; // Client non trouvé
-} 
\ No newline at end of file
+}
+
+// Trouver un client par son nickname (insensible à la casse, O(1))
+Client* Server::findClientByNickname(const StringRef& nickname) {
+    return _nicknames.find(nickname); // NULL: client non trouvé
+}
+
+// Changer le nickname d'un client en maintenant l'index
+// Un simple changement de casse de son propre nickname est autorisé. Les parts de
+// l'ancien et du nouveau nickname sont verrouillées ensemble: un nickname n'est
+// jamais vu libre pendant le changement, ni attribué à deux clients.
+bool Server::changeNickname(Client* client, const std::string& nickname) {
+    typedef ShardedCaseMap<Client*>::Shard Shard;
+    Shard* to = &_nicknames.shardFor(nickname);
+    Shard* from = client->getNickname().empty() ? to : &_nicknames.shardFor(client->getNickname());
+    LockGuard first(from < to ? &from->lock : &to->lock);
+    LockGuard second(from != to ? (from < to ? &to->lock : &from->lock) : NULL);
+    
+    Client** owner = to->map.find(nickname);
+    if (owner != NULL && *owner != client) {
+        return false;
+    }
+    if (!client->getNickname().empty()) {
+        from->map.erase(client->getNickname());
+    }
+    to->map.insert(nickname, client);
+    client->setNickname(nickname);
+    return true;
+}
@@ -0,0 +1,112 @@
+#include "ServerConfig.hpp"
+#include <cstdlib>
+
+// Convertir une valeur entière positive ou nulle, false si invalide
+static bool parseCount(const std::string& value, int max_value, int& out) {
+    if (value.empty()) {
+        return false;
+    }
+    char* endptr;
+    long parsed = std::strtol(value.c_str(), &endptr, 10);
+    if (*endptr != '\0' || parsed < 0 || parsed > max_value) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+// Appliquer une option "--clé=valeur"
+bool ServerConfig::parseOption(const std::string& option) {
+    if (option.compare(0, 2, "--") != 0) {
+        return false;
+    }
+    size_t eq_pos = option.find('=');
+    if (eq_pos == std::string::npos) {
+        return false;
+    }
+    std::string key = option.substr(2, eq_pos - 2);
+    std::string value = option.substr(eq_pos + 1);
+
+    if (key == "engine") {
+        if (value != "io_uring" && value != "epoll" && value != "poll") {
+            return false;
+        }
+        engine = value;
+        return true;
+    }
+    if (key == "flush-delay-ms") {
+        return parseCount(value, 1000, flush_delay_ms);
+    }
+    if (key == "recvq") {
+        return parseCount(value, 1 << 20, recvq_bytes) && recvq_bytes >= 512;
+    }
+    if (key == "sendq") {
+        return parseCount(value, 1 << 30, sendq_bytes) && sendq_bytes >= 512;
+    }
+    if (key == "sendq-soft") {
+        return parseCount(value, 1 << 30, sendq_soft_bytes);
+    }
+    if (key == "flood-burst") {
+        return parseCount(value, 1000, flood_burst) && flood_burst >= 1;
+    }
+    if (key == "flood-rate") {
+        return parseCount(value, 1000000, flood_rate);
+    }
+    if (key == "excess-flood") {
+        if (value != "disconnect" && value != "block") {
+            return false;
+        }
+        flood_disconnect = (value == "disconnect");
+        return true;
+    }
+    if (key == "listen-backlog") {
+        return parseCount(value, 65535, listen_backlog) && listen_backlog >= 1;
+    }
+    if (key == "accept-batch") {
+        return parseCount(value, 100000, accept_batch) && accept_batch >= 1;
+    }
+    if (key == "registration-timeout") {
+        return parseCount(value, 86400, registration_timeout);
+    }
+    if (key == "ping-interval") {
+        return parseCount(value, 86400, ping_interval);
+    }
+    if (key == "ping-timeout") {
+        return parseCount(value, 86400, ping_timeout) && ping_timeout >= 1;
+    }
+    if (key == "threads") {
+        return parseCount(value, 64, threads) && threads >= 1;
+    }
+    if (key == "max-clients") {
+        return parseCount(value, 1 << 20, max_clients);
+    }
+    if (key == "max-channels") {
+        return parseCount(value, 1 << 20, max_channels) && max_channels >= 1;
+    }
+    if (key == "history-lines") {
+        return parseCount(value, 100000, history_lines);
+    }
+    if (key == "history-bytes") {
+        return parseCount(value, 1 << 30, history_bytes) && history_bytes >= 512;
+    }
+    if (key == "history-budget") {
+        return parseCount(value, 1 << 30, history_budget);
+    }
+    if (key == "history-replay") {
+        return parseCount(value, 100000, history_replay);
+    }
+    if (key == "log-level") {
+        return Logger::parseLevel(value, log_level);
+    }
+    if (key == "log-categories") {
+        return Logger::parseCategories(value, log_categories);
+    }
+    if (key == "metrics-port") {
+        return parseCount(value, 65535, metrics_port);
+    }
+    if (key == "oper-password") {
+        oper_password = value;
+        return !value.empty();
+    }
+    return false;
+}
@@ -0,0 +1,71 @@
+#include "SharedBuffer.hpp"
+#include <cstring>
+#include <new>
+
+SharedBuffer::SharedBuffer(const std::string& data) : _block(NULL) {
+    _init(data.data(), data.length(), data.length());
+}
+
+SharedBuffer::SharedBuffer(const char* data, size_t length) : _block(NULL) {
+    _init(data, length, length);
+}
+
+SharedBuffer SharedBuffer::reserve(size_t capacity) {
+    SharedBuffer buffer;
+    buffer._init(NULL, 0, capacity);
+    return buffer;
+}
+
+// Copier les données une fois dans un bloc unique (en-tête + octets)
+void SharedBuffer::_init(const char* data, size_t length, size_t capacity) {
+    if (capacity == 0) {
+        return;
+    }
+    _block = static_cast<Block*>(::operator new(sizeof(Block) + capacity));
+    _block->refcount = 1;
+    _block->length = length;
+    _block->capacity = capacity;
+    if (length > 0) {
+        std::memcpy(_block->data, data, length);
+    }
+}
+
+// Seul détenteur et place suffisante: personne d'autre ne lit le bloc, on peut l'étendre
+bool SharedBuffer::tryAppend(const char* data, size_t length) {
+    if (_block == NULL || _block->capacity - _block->length < length ||
+        __atomic_load_n(&_block->refcount, __ATOMIC_ACQUIRE) != 1) {
+        return false;
+    }
+    std::memcpy(_block->data + _block->length, data, length);
+    _block->length += length;
+    return true;
+}
+
+SharedBuffer::SharedBuffer(const SharedBuffer& other) : _block(other._block) {
+    if (_block) {
+        __atomic_add_fetch(&_block->refcount, 1, __ATOMIC_RELAXED);
+    }
+}
+
+SharedBuffer& SharedBuffer::operator=(const SharedBuffer& other) {
+    if (_block != other._block) {
+        if (other._block) {
+            __atomic_add_fetch(&other._block->refcount, 1, __ATOMIC_RELAXED);
+        }
+        _release();
+        _block = other._block;
+    }
+    return *this;
+}
+
+SharedBuffer::~SharedBuffer() {
+    _release();
+}
+
+// Libérer le bloc quand la dernière référence disparaît
+void SharedBuffer::_release() {
+    if (_block && __atomic_sub_fetch(&_block->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        ::operator delete(_block);
+    }
+    _block = NULL;
+}
@@ -0,0 +1,92 @@
+#include "TickArena.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#define ARENA_ALIGN 16
+
+static size_t alignUp(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~static_cast<size_t>(ARENA_ALIGN - 1);
+}
+
+TickArena::TickArena(size_t chunk_size)
+    : _current(NULL), _chunk_size(alignUp(chunk_size)), _total_used(0), _high_water(0) {
+    _current = _newChunk(_chunk_size, NULL);
+}
+
+TickArena::~TickArena() {
+    while (_current != NULL) {
+        Chunk* next = _current->next;
+        std::free(_current);
+        _current = next;
+    }
+}
+
+// En-tête suivi des données (l'en-tête fait un multiple de 16 octets sur 64 bits)
+TickArena::Chunk* TickArena::_newChunk(size_t size, Chunk* next) {
+    Chunk* chunk = static_cast<Chunk*>(std::malloc(alignUp(sizeof(Chunk)) + size));
+    if (chunk == NULL) {
+        throw std::bad_alloc();
+    }
+    chunk->next = next;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+void* TickArena::allocate(size_t size) {
+    size = alignUp(size ? size : 1);
+    if (_current->used + size > _current->size) {
+        // Débordement: nouveau bloc, au moins aussi grand que la demande
+        _current = _newChunk(size > _chunk_size ? size : _chunk_size, _current);
+    }
+    void* ptr = _chunkData(_current) + _current->used;
+    _current->used += size;
+    _total_used += size;
+    return ptr;
+}
+
+// Tout rendre; après un débordement, remplacer la chaîne par un bloc unique
+// dimensionné sur le pic observé
+void TickArena::reset() {
+    if (_total_used > _high_water) {
+        _high_water = _total_used;
+    }
+    if (_current->next != NULL) {
+        while (_current != NULL) {
+            Chunk* next = _current->next;
+            std::free(_current);
+            _current = next;
+        }
+        _chunk_size = alignUp(_high_water);
+        _current = _newChunk(_chunk_size, NULL);
+    }
+    _current->used = 0;
+    _total_used = 0;
+}
+
+LineBuilder::LineBuilder(TickArena& arena, size_t capacity)
+    : _arena(arena), _data(static_cast<char*>(arena.allocate(capacity))), _length(0), _capacity(capacity) {
+}
+
+// Agrandir en doublant: l'ancienne zone reste dans l'arène jusqu'au reset
+void LineBuilder::_reserve(size_t extra) {
+    if (_length + extra <= _capacity) {
+        return;
+    }
+    size_t capacity = _capacity ? _capacity * 2 : 64;
+    while (capacity < _length + extra) {
+        capacity *= 2;
+    }
+    char* data = static_cast<char*>(_arena.allocate(capacity));
+    std::memcpy(data, _data, _length);
+    _data = data;
+    _capacity = capacity;
+}
+
+LineBuilder& LineBuilder::append(const char* data, size_t length) {
+    _reserve(length);
+    std::memcpy(_data + _length, data, length);
+    _length += length;
+    return *this;
+}
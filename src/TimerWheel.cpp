@@ -0,0 +1,157 @@
+#include "TimerWheel.hpp"
+
+#define TIMER_LEVEL0_MASK (TIMER_LEVEL0_SIZE - 1)
+#define TIMER_LEVEL_MASK (TIMER_LEVEL_SIZE - 1)
+
+TimerWheel::TimerWheel(long now_ms) : _count(0), _current_ms(now_ms) {
+    for (int i = 0; i < TIMER_LEVEL0_SIZE; ++i) {
+        _level0[i] = NULL;
+    }
+    for (int level = 0; level < TIMER_LEVELS - 1; ++level) {
+        for (int i = 0; i < TIMER_LEVEL_SIZE; ++i) {
+            _levels[level][i] = NULL;
+        }
+    }
+    for (int level = 0; level < TIMER_LEVELS; ++level) {
+        _counts[level] = 0;
+    }
+}
+
+void TimerWheel::schedule(Timer* timer, long expires_ms) {
+    if (timer->armed()) {
+        _unlink(timer);
+    }
+    timer->expires_ms = expires_ms;
+    _insert(timer);
+}
+
+void TimerWheel::cancel(Timer* timer) {
+    if (timer->armed()) {
+        _unlink(timer);
+    }
+}
+
+// Ranger un timer selon la distance de son échéance à la milliseconde courante
+// Une échéance déjà passée tombe dans la case traitée au prochain advance().
+void TimerWheel::_insert(Timer* timer) {
+    long expires = timer->expires_ms < _current_ms ? _current_ms : timer->expires_ms;
+    long delta = expires - _current_ms;
+    Timer** slot;
+    int level = 0;
+
+    if (delta < TIMER_LEVEL0_SIZE) {
+        slot = &_level0[expires & TIMER_LEVEL0_MASK];
+    } else {
+        level = 1;
+        while (level < TIMER_LEVELS - 1 && delta >= (1L << (_shift(level) + TIMER_LEVEL_BITS))) {
+            ++level;
+        }
+        long range = 1L << (_shift(level) + TIMER_LEVEL_BITS);
+        if (delta >= range) {
+            expires = _current_ms + range - 1; // Hors de portée: revu à chaque tour du dernier niveau
+        }
+        slot = &_levels[level - 1][(expires >> _shift(level)) & TIMER_LEVEL_MASK];
+    }
+
+    timer->level = level;
+    timer->next = *slot;
+    if (timer->next != NULL) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = slot;
+    *slot = timer;
+    ++_counts[level];
+    ++_count;
+}
+
+void TimerWheel::_unlink(Timer* timer) {
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+    --_counts[timer->level];
+    --_count;
+}
+
+// Début d'un tour du niveau 0: redistribuer la case courante du niveau 1,
+// et celle du niveau suivant si le niveau 1 vient lui-même de boucler
+void TimerWheel::_cascade() {
+    for (int level = 1; level < TIMER_LEVELS; ++level) {
+        int index = (_current_ms >> _shift(level)) & TIMER_LEVEL_MASK;
+        Timer* timer = _levels[level - 1][index];
+        while (timer != NULL) {
+            Timer* next = timer->next;
+            _unlink(timer);
+            _insert(timer);
+            timer = next;
+        }
+        if (index != 0) {
+            return;
+        }
+    }
+}
+
+// Traiter chaque milliseconde écoulée depuis l'appel précédent
+// Les tours du niveau 0 sans timer sont sautés d'un bloc: après une longue attente,
+// le rattrapage coûte au plus une étape par tour de 256 ms.
+void TimerWheel::advance(long now_ms, std::vector<Timer*>& expired) {
+    while (_current_ms <= now_ms) {
+        if (_count == 0) {
+            _current_ms = now_ms + 1;
+            return;
+        }
+        if ((_current_ms & TIMER_LEVEL0_MASK) == 0) {
+            _cascade();
+        }
+        if (_counts[0] == 0) {
+            long next_turn = (_current_ms | TIMER_LEVEL0_MASK) + 1;
+            _current_ms = next_turn > now_ms ? now_ms + 1 : next_turn;
+            continue;
+        }
+
+        Timer** slot = &_level0[_current_ms & TIMER_LEVEL0_MASK];
+        while (*slot != NULL) {
+            Timer* timer = *slot;
+            _unlink(timer);
+            expired.push_back(timer);
+        }
+        ++_current_ms;
+    }
+}
+
+// Parcours de cases en nombre borné (256 + 64 par niveau), indépendant du nombre de timers
+long TimerWheel::nextExpiry() const {
+    if (_count == 0) {
+        return -1;
+    }
+    long best = -1;
+    if (_counts[0] > 0) {
+        for (long ms = _current_ms; ms < _current_ms + TIMER_LEVEL0_SIZE; ++ms) {
+            if (_level0[ms & TIMER_LEVEL0_MASK] != NULL) {
+                best = ms;
+                break;
+            }
+        }
+    }
+    for (int level = 1; level < TIMER_LEVELS; ++level) {
+        if (_counts[level] == 0) {
+            continue;
+        }
+        // La case de la position courante a déjà été redistribuée (elle attend le tour
+        // suivant), sauf si l'on est pile au début de la position: cascade imminente
+        long position = _current_ms >> _shift(level);
+        long first = (_current_ms & ((1L << _shift(level)) - 1)) == 0 ? position : position + 1;
+        for (long next = first; next < first + TIMER_LEVEL_SIZE; ++next) {
+            if (_levels[level - 1][next & TIMER_LEVEL_MASK] != NULL) {
+                long cascade_ms = next << _shift(level);
+                if (best < 0 || cascade_ms < best) {
+                    best = cascade_ms;
+                }
+                break;
+            }
+        }
+    }
+    return best;
+}
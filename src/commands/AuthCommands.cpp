@@ -1,43 +1,44 @@
 #include "../../include/commands/AuthCommands.hpp"
 #include "../../include/Server.hpp"
 #include "../../include/Client.hpp"
+#include "../../include/IrcMessage.hpp"
 #include "../../include/utils.hpp"
-#include <iostream>
+#include "../../include/Logger.hpp"
+#include <cstdio>
 
 // Gérer la commande PASS (authentification password)
-void AuthCommands::handlePass(Server* server, Client* client, const std::string& args) {
-    std::cout << "Handling PASS command for client " << client->getFd() << std::endl;
-    
-    if (args.empty()) {
-        server->sendResponse(client, "461 * PASS :Not enough parameters\r\n");
-        return;
-    }
+void AuthCommands::handlePass(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling PASS command for client " << client->getFd());
     
     // Comparer avec le mot de passe du serveur
-    if (args == server->getPassword()) {
+    if (msg.params[0] == StringRef(server->getPassword())) {
         client->setPasswordOk(true);
-        std::cout << "Client " << client->getFd() << " provided correct password" << std::endl;
+        LOG_DEBUG(LOG_CMD, "Client " << client->getFd() << " provided correct password");
         // Pas de réponse immédiate pour PASS selon RFC 1459
     } else {
-        std::cout << "Client " << client->getFd() << " provided wrong password" << std::endl;
-        server->sendResponse(client, "464 * :Password incorrect\r\n");
+        LOG_DEBUG(LOG_CMD, "Client " << client->getFd() << " provided wrong password");
+        server->sendNumeric(client, ERR_PASSWDMISMATCH);
     }
 }
 
 // Gérer la commande NICK (définir nickname)
-void AuthCommands::handleNick(Server* server, Client* client, const std::string& args) {
-    std::cout << "Handling NICK command for client " << client->getFd() << std::endl;
+void AuthCommands::handleNick(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling NICK command for client " << client->getFd());
     
-    if (args.empty()) {
-        server->sendResponse(client, "431 * :No nickname given\r\n");
+    if (msg.param(0).empty()) {
+        server->sendNumeric(client, ERR_NONICKNAMEGIVEN);
         return;
     }
     
+    const StringRef& nickname = msg.params[0];
     
-    std::string old_nick = client->getNickname();
-    client->setNickname(args);
+    // Collision détectée en O(1) via l'index des nicknames
+    if (!server->changeNickname(client, nickname.str())) {
+        server->sendNumeric(client, ERR_NICKNAMEINUSE, nickname);
+        return;
+    }
     
-    std::cout << "Client " << client->getFd() << " nickname set to: " << args << std::endl;
+    LOG_DEBUG(LOG_CMD, "Client " << client->getFd() << " nickname set to: " << nickname);
     
     // Si le client est maintenant complètement enregistré, envoyer les messages de bienvenue
     if (client->isAuthenticated()) {
@@ -46,41 +47,31 @@ void AuthCommands::handleNick(Server* server, Client* client, const std::string&
 }
 
 // Gérer la commande USER (définir username et realname)
-void AuthCommands::handleUser(Server* server, Client* client, const std::string& args) {
-    std::cout << "Handling USER command for client " << client->getFd() << std::endl;
+void AuthCommands::handleUser(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling USER command for client " << client->getFd());
     
-    if (args.empty()) {
-        server->sendResponse(client, "461 * USER :Not enough parameters\r\n");
+    if (msg.params[0].empty()) {
+        server->sendNumeric(client, ERR_NEEDMOREPARAMS, "USER");
+        return;
+    }
+    // Username figé une fois enregistré (lu depuis d'autres shards: STATS l)
+    if (client->isRegistered()) {
+        server->sendNumeric(client, ERR_ALREADYREGISTRED);
         return;
     }
     
     // Format USER: username hostname servername :realname
     // Exemple: USER john localhost localhost :John Doe
-    
-    // Parser les arguments (on simplifie pour l'instant)
-    size_t colon_pos = args.find(" :");
-    std::string username_part;
-    std::string realname;
-    
-    if (colon_pos != std::string::npos) {
-        username_part = args.substr(0, colon_pos);
-        realname = args.substr(colon_pos + 2); // +2 pour passer " :"
-    } else {
-        username_part = args;
-        realname = "Unknown";
-    }
-    
-    // Extraire juste le premier mot comme username
-    size_t space_pos = username_part.find(' ');
-    std::string username = (space_pos != std::string::npos) ? 
-                          username_part.substr(0, space_pos) : username_part;
+    std::string username = msg.params[0].str();
+    std::string realname = (msg.has_trailing && msg.param_count > 1) ? 
+                          msg.params[msg.param_count - 1].str() : "Unknown";
     
     client->setUsername(username);
     client->setRealname(realname);
     
-    std::cout << "Client " << client->getFd() 
+    LOG_DEBUG(LOG_CMD, "Client " << client->getFd() 
               << " user info set - Username: " << username 
-              << ", Realname: " << realname << std::endl;
+              << ", Realname: " << realname);
     
     // Si le client est maintenant complètement enregistré, envoyer les messages de bienvenue
     if (client->isAuthenticated()) {
@@ -88,21 +79,47 @@ void AuthCommands::handleUser(Server* server, Client* client, const std::string&
     }
 }
 
+// Gérer la commande OPER (devenir IRC opérateur)
+void AuthCommands::handleOper(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling OPER command for " << client->getNickname());
+    
+    // Parser: OPER <name> <password> (le nom n'est pas vérifié, un seul mot de passe)
+    const std::string& oper_password = server->getConfig().oper_password;
+    if (oper_password.empty()) {
+        server->sendNumeric(client, ERR_NOOPERHOST);
+        return;
+    }
+    if (msg.params[1] != StringRef(oper_password)) {
+        server->sendNumeric(client, ERR_PASSWDMISMATCH);
+        return;
+    }
+    
+    client->setServerOperator(true);
+    LOG_INFO(LOG_CLIENT, "Client " << client->getNickname() << " is now an IRC operator");
+    server->sendNumeric(client, RPL_YOUREOPER);
+}
+
 // Envoyer les messages de bienvenue IRC
 void AuthCommands::sendWelcomeMessages(Server* server, Client* client) {
-    std::cout << "Sending welcome messages to " << client->getNickname() << std::endl;
-    
-    std::string nick = client->getNickname();
+    LOG_DEBUG(LOG_CMD, "Sending welcome messages to " << client->getNickname());
     
     // 001 RPL_WELCOME
-    server->sendResponse(client, "001 " + nick + " :Welcome to the Internet Relay Network " + nick + "\r\n");
+    server->sendNumeric(client, RPL_WELCOME, client->getNickname());
     
     // 002 RPL_YOURHOST  
-    server->sendResponse(client, "002 " + nick + " :Your host is localhost, running version 1.0\r\n");
+    server->sendNumeric(client, RPL_YOURHOST);
     
     // 003 RPL_CREATED
-    server->sendResponse(client, "003 " + nick + " :This server was created today\r\n");
+    server->sendNumeric(client, RPL_CREATED);
     
     // 004 RPL_MYINFO
-    server->sendResponse(client, "004 " + nick + " localhost 1.0 o o\r\n");
+    server->sendNumeric(client, RPL_MYINFO);
+    
+    // 005 RPL_ISUPPORT: taille maximale d'une réponse CHATHISTORY (historique activé)
+    if (server->getHistoryMaxLines() > 0) {
+        char chathistory[32];
+        std::snprintf(chathistory, sizeof(chathistory), "CHATHISTORY=%lu",
+                      static_cast<unsigned long>(server->getHistoryMaxLines()));
+        server->sendNumeric(client, RPL_ISUPPORT, chathistory);
+    }
 } 
\ No newline at end of file
@@ -2,85 +2,185 @@
 #include "../../include/Server.hpp"
 #include "../../include/Client.hpp"
 #include "../../include/Channel.hpp"
-#include <iostream>
-#include <sys/socket.h>
-#include <cerrno>
+#include "../../include/IrcMessage.hpp"
+#include "../../include/Reactor.hpp"
+#include "../../include/LockGuard.hpp"
+#include "../../include/Logger.hpp"
+#include "../../include/utils.hpp"
+#include <cstdio>
 #include <cstring>
+#include <ctime>
+
+#define HISTORY_TIMESTAMP_MAX 40            // "2024-01-01T00:00:00.000Z" avec de la marge
 
 // Gérer la commande PRIVMSG (envoyer un message)
-void MessageCommands::handlePrivmsg(Server* server, Client* client, const std::string& args) {
-    std::cout << "Handling PRIVMSG command for " << client->getNickname() << std::endl;
-    
-    // Vérifier que le client est authentifié
-    if (!client->isAuthenticated()) {
-        server->sendResponse(client, "451 * :You have not registered\r\n");
-        return;
-    }
-    
-    if (args.empty()) {
-        server->sendResponse(client, "461 " + client->getNickname() + " PRIVMSG :Not enough parameters\r\n");
-        return;
-    }
+void MessageCommands::handlePrivmsg(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling PRIVMSG command for " << client->getNickname());
     
     // Parser: PRIVMSG <target> :<message>
-    size_t space_pos = args.find(' ');
-    if (space_pos == std::string::npos) {
-        server->sendResponse(client, "461 " + client->getNickname() + " PRIVMSG :Not enough parameters\r\n");
-        return;
-    }
-    
-    std::string target = args.substr(0, space_pos);
-    std::string message_part = args.substr(space_pos + 1);
-    
-    if (message_part.empty() || message_part[0] != ':') {
-        server->sendResponse(client, "461 " + client->getNickname() + " PRIVMSG :Not enough parameters\r\n");
+    if (msg.params[0].empty() || msg.params[1].empty()) {
+        server->sendNumeric(client, ERR_NEEDMOREPARAMS, "PRIVMSG");
         return;
     }
     
-    std::string message = message_part.substr(1); // Enlever le ':'
+    const StringRef& target = msg.params[0];
+    const StringRef& message = msg.params[1];
     
-    std::cout << "PRIVMSG from " << client->getNickname() << " to " << target << ": " << message << std::endl;
+    LOG_DEBUG(LOG_CMD, "PRIVMSG from " << client->getNickname() << " to " << target << ": " << message);
     
-    // Construire le message IRC à envoyer
-    std::string irc_message = ":" + client->getNickname() + " PRIVMSG " + target + " :" + message + "\r\n";
+    // Construire le message IRC à envoyer (dans l'arène de l'itération)
+    LineBuilder line(Reactor::current()->getArena());
+    line << client->getPrefix() << " PRIVMSG " << target << " :" << message << "\r\n";
+    StringRef irc_message = line.ref();
     
     // Vérifier si c'est un channel (commence par #)
     if (target[0] == '#') {
-        // Message vers un channel - utiliser la méthode publique
-        Channel* channel = server->getOrCreateChannel(target);
+        // Message vers un channel: encodé avant de prendre son verrou
+        SharedBuffer encoded(irc_message.data, irc_message.length);
+        Channel* channel = server->lockChannel(target);
         if (channel != NULL) {
+            LockGuard guard(channel->getLock(), LOCK_ADOPT);
             if (channel->isMember(client)) {
-                // Broadcaster le message aux autres membres du channel
-                channel->broadcastMessage(irc_message, client);
+                // Relever les autres membres, l'historique garde le même bloc, puis diffuser hors verrou
+                std::vector<Client*>& recipients = Reactor::current()->getRecipients();
+                channel->collectMembers(recipients, client);
+                server->recordHistory(channel, encoded);
+                guard.unlock();
+                server->deliver(recipients, encoded);
             } else {
-                server->sendResponse(client, "404 " + client->getNickname() + " " + target + " :Cannot send to channel\r\n");
+                server->sendNumeric(client, ERR_CANNOTSENDTOCHAN, target);
             }
         } else {
-            server->sendResponse(client, "403 " + client->getNickname() + " " + target + " :No such channel\r\n");
+            server->sendNumeric(client, ERR_NOSUCHCHANNEL, target);
         }
     } else {
         // Message privé vers un utilisateur
         Client* target_client = server->findClientByNickname(target);
         if (target_client != NULL) {
             // Envoyer le message au client cible
-            target_client->appendToSendBuffer(irc_message);
-            
-            // Essayer d'envoyer immédiatement
-            const std::string& send_buffer = target_client->getSendBuffer();
-            if (!send_buffer.empty()) {
-                ssize_t bytes_sent = send(target_client->getFd(), send_buffer.c_str(), send_buffer.length(), 0);
-                
-                if (bytes_sent > 0) {
-                    target_client->clearSendBuffer(bytes_sent);
-                    std::cout << "Private message sent from " << client->getNickname() 
-                              << " to " << target << ": " << message << std::endl;
-                } else if (bytes_sent < 0 && errno != EWOULDBLOCK && errno != EAGAIN) {
-                    std::cerr << "Error sending private message to " << target << ": " 
-                              << strerror(errno) << std::endl;
-                }
-            }
+            server->sendResponse(target_client, irc_message);
+            LOG_DEBUG(LOG_CMD, "Private message queued from " << client->getNickname() << " to " << target);
         } else {
-            server->sendResponse(client, "401 " + client->getNickname() + " " + target + " :No such nick/channel\r\n");
+            server->sendNumeric(client, ERR_NOSUCHNICK, target);
+        }
+    }
+}
+
+// Réponse standard IRCv3: "FAIL CHATHISTORY <code> <contexte> :<description>"
+static void sendHistoryFail(Server* server, Client* client, const char* code, const StringRef& context,
+                            const char* description) {
+    LineBuilder line(Reactor::current()->getArena());
+    line << "FAIL CHATHISTORY " << code << ' ' << context << " :" << description << "\r\n";
+    server->sendResponse(client, line.ref());
+}
+
+// "timestamp=YYYY-MM-DDThh:mm:ss[.sss]Z" -> millisecondes depuis l'epoch
+static bool parseTimestamp(const StringRef& selector, long long& time_ms) {
+    static const StringRef prefix("timestamp=");
+    char value[HISTORY_TIMESTAMP_MAX];
+    if (selector.length <= prefix.length || selector.length - prefix.length >= sizeof(value) ||
+        !(StringRef(selector.data, prefix.length) == prefix)) {
+        return false;
+    }
+    std::memcpy(value, selector.data + prefix.length, selector.length - prefix.length);
+    value[selector.length - prefix.length] = '\0';
+    
+    struct tm date;
+    std::memset(&date, 0, sizeof(date));
+    int millis = 0;
+    int consumed = 0;
+    if (std::sscanf(value, "%4d-%2d-%2dT%2d:%2d:%2d%n", &date.tm_year, &date.tm_mon, &date.tm_mday,
+                    &date.tm_hour, &date.tm_min, &date.tm_sec, &consumed) != 6) {
+        return false;
+    }
+    const char* rest = value + consumed;
+    if (*rest == '.') {
+        int digits = 0;
+        for (++rest; *rest >= '0' && *rest <= '9'; ++rest, ++digits) {
+            if (digits < 3) {
+                millis = millis * 10 + (*rest - '0');
+            }
+        }
+        for (; digits < 3; ++digits) {
+            millis *= 10;
         }
     }
-} 
\ No newline at end of file
+    if (rest[0] != 'Z' || rest[1] != '\0') {
+        return false;
+    }
+    date.tm_year -= 1900;
+    date.tm_mon -= 1;
+    time_ms = static_cast<long long>(timegm(&date)) * 1000LL + millis;
+    return true;
+}
+
+// Gérer la commande CHATHISTORY (IRCv3), servie depuis l'historique du channel
+// CHATHISTORY LATEST <channel> <* | timestamp=...> <limite>
+// CHATHISTORY BEFORE|AFTER <channel> <timestamp=...> <limite>
+// Les lignes sont renvoyées telles que diffusées (mêmes blocs), de la plus ancienne à la plus récente.
+// La limite est plafonnée à CHATHISTORY=<max> (005), soit --history-lines.
+// Sans message-tags, les lignes ne portent pas leur horodatage (UTC, à la milliseconde,
+// pris à la réception par le serveur): un client pagine avec sa propre horloge, par
+// exemple BEFORE avec l'heure de son JOIN pour remonter au-delà de ce qui a été rejoué,
+// puis BEFORE avec l'heure d'arrivée de la plus ancienne ligne déjà reçue. Les bornes
+// sont exclusives: un écart d'horloge ne fait que décaler la fenêtre.
+void MessageCommands::handleChathistory(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling CHATHISTORY command for " << client->getNickname());
+    
+    const StringRef& subcommand = msg.params[0];
+    const StringRef& target = msg.params[1];
+    const StringRef& selector = msg.params[2];
+    
+    bool latest = ircEqualsIgnoreCase(subcommand, "LATEST");
+    bool before = ircEqualsIgnoreCase(subcommand, "BEFORE");
+    bool after = ircEqualsIgnoreCase(subcommand, "AFTER");
+    if (!latest && !before && !after) {
+        sendHistoryFail(server, client, "INVALID_PARAMS", subcommand, "Unknown subcommand");
+        return;
+    }
+    
+    // Limite: entier strictement positif, tous les caractères vérifiés avant le plafond
+    size_t limit = 0;
+    const StringRef& limit_param = msg.params[3];
+    bool valid = !limit_param.empty();
+    for (size_t i = 0; i < limit_param.length && valid; ++i) {
+        valid = limit_param[i] >= '0' && limit_param[i] <= '9';
+        if (valid && limit <= server->getHistoryMaxLines()) { // Saturé au-delà: sans débordement
+            limit = limit * 10 + (limit_param[i] - '0');
+        }
+    }
+    if (!valid || limit == 0) {
+        sendHistoryFail(server, client, "INVALID_PARAMS", subcommand, "Invalid limit");
+        return;
+    }
+    if (limit > server->getHistoryMaxLines()) {
+        limit = server->getHistoryMaxLines();
+    }
+    
+    long long time_ms = 0;
+    bool everything = latest && selector == StringRef("*");
+    if (!everything && !parseTimestamp(selector, time_ms)) {
+        sendHistoryFail(server, client, "INVALID_PARAMS", subcommand, "Invalid message reference");
+        return;
+    }
+    
+    Channel* channel = target.empty() || target[0] != '#' ? NULL : server->lockChannel(target);
+    LockGuard guard(channel != NULL ? channel->getLock() : NULL, LOCK_ADOPT);
+    if (channel == NULL || !channel->isMember(client)) {
+        guard.unlock();
+        LineBuilder line(Reactor::current()->getArena());
+        line << subcommand << ' ' << target;
+        sendHistoryFail(server, client, "INVALID_TARGET", line.ref(), "Messages could not be retrieved");
+        return;
+    }
+    
+    // Copier la fenêtre sous le verrou, l'envoyer après
+    HistoryQuery query = everything ? HISTORY_LATEST_ALL : latest ? HISTORY_LATEST : before ? HISTORY_BEFORE : HISTORY_AFTER;
+    std::vector<SharedBuffer> lines;
+    server->selectHistory(channel, query, time_ms, limit, lines);
+    guard.unlock();
+    
+    for (size_t i = 0; i < lines.size(); ++i) {
+        server->sendMessage(client, lines[i]);
+    }
+}
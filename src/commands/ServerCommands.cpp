@@ -0,0 +1,153 @@
+#include "../../include/commands/ServerCommands.hpp"
+#include "../../include/Server.hpp"
+#include "../../include/Client.hpp"
+#include "../../include/IrcMessage.hpp"
+#include "../../include/Metrics.hpp"
+#include "../../include/Reactor.hpp"
+#include "../../include/utils.hpp"
+#include "../../include/Logger.hpp"
+#include <cstdio>
+
+// Gérer la commande STATS (instrumentation, IRC opérateurs uniquement)
+// Requêtes: m (commandes), e (erreurs), t (trafic), q (SendQ), u (uptime); sans paramètre: tout
+// sauf l (SendQ de chaque client, potentiellement long)
+void ServerCommands::handleStats(Server* server, Client* client, const IrcMessage& msg) {
+    LOG_DEBUG(LOG_CMD, "Handling STATS command for " << client->getNickname());
+    
+    if (!client->isServerOperator()) {
+        server->sendNumeric(client, ERR_NOPRIVILEGES);
+        return;
+    }
+    
+    char query = msg.param(0).empty() ? '*' : msg.params[0][0];
+    MetricsSnapshot snapshot;
+    server->collectMetrics(snapshot);
+    
+    if (query == 'm' || query == '*') {
+        sendCommandStats(server, client, snapshot);
+    }
+    if (query == 'e' || query == '*') {
+        sendErrorStats(server, client, snapshot);
+    }
+    if (query == 't' || query == '*') {
+        sendTrafficStats(server, client, snapshot);
+    }
+    if (query == 'q' || query == '*') {
+        sendSendqStats(server, client, snapshot);
+    }
+    if (query == 'u' || query == '*') {
+        sendUptime(server, client, snapshot);
+    }
+    if (query == 'l') {
+        sendLinkInfo(server, client);
+    }
+    
+    // 219 RPL_ENDOFSTATS
+    server->sendNumeric(client, RPL_ENDOFSTATS, StringRef(&query, 1));
+}
+
+// 212 RPL_STATSCOMMANDS: nombre d'appels et durée des handlers
+void ServerCommands::sendCommandStats(Server* server, Client* client, const MetricsSnapshot& snapshot) {
+    const Metrics& totals = snapshot.totals;
+    for (size_t i = 0; i < CMD_COUNT; ++i) {
+        if (totals.commands[i] == 0) {
+            continue;
+        }
+        const Histogram& latency = totals.command_ns[i];
+        server->sendResponse(client, "212 " + client->getNickname() + " " 
+                             + CommandTable::get(static_cast<CommandId>(i)).name + " " + intToString(totals.commands[i])
+                             + " :handler p50<=" + intToString(latency.percentile(0.50))
+                             + "ns p99<=" + intToString(latency.percentile(0.99)) + "ns\r\n");
+    }
+    server->sendResponse(client, "212 " + client->getNickname() + " UNKNOWN " 
+                         + intToString(totals.commands[METRICS_UNKNOWN_COMMAND]) + "\r\n");
+}
+
+// 249 RPL_STATSDEBUG: réponses d'erreur envoyées, par numérique
+void ServerCommands::sendErrorStats(Server* server, Client* client, const MetricsSnapshot& snapshot) {
+    for (size_t i = 0; i < METRICS_NUMERIC_COUNT; ++i) {
+        if (snapshot.totals.numerics[i] > 0) {
+            server->sendResponse(client, "249 " + client->getNickname() + " :error " 
+                                 + intToString(METRICS_NUMERIC_MIN + i) + " sent "
+                                 + intToString(snapshot.totals.numerics[i]) + " times\r\n");
+        }
+    }
+}
+
+// 249 RPL_STATSDEBUG: octets, connexions, clients et channels
+void ServerCommands::sendTrafficStats(Server* server, Client* client, const MetricsSnapshot& snapshot) {
+    const Metrics& totals = snapshot.totals;
+    const std::string prefix = "249 " + client->getNickname() + " :";
+    long uptime = snapshot.uptime_s > 0 ? snapshot.uptime_s : 1;
+    
+    server->sendResponse(client, prefix + "bytes in " + intToString(totals.bytes_in) 
+                         + ", out " + intToString(totals.bytes_out) + "\r\n");
+    server->sendResponse(client, prefix + "connections accepted " + intToString(totals.accepted) 
+                         + " (" + intToString(totals.accepted / uptime) + "/s average)\r\n");
+    server->sendResponse(client, prefix + "accept queue p99 " + intToString(totals.accept_queue.percentile(0.99)) 
+                         + ", full " + intToString(totals.accept_queue_full) 
+                         + ", capped batches " + intToString(totals.accept_batches_capped) 
+                         + ", kernel listen overflows " + intToString(snapshot.listen_overflows) + "\r\n");
+    server->sendResponse(client, prefix + "clients " + intToString(totals.clients) 
+                         + ", channels " + intToString(snapshot.channels) 
+                         + ", reactors " + intToString(snapshot.reactors) + "\r\n");
+    server->sendResponse(client, prefix + "history bytes " + intToString(snapshot.history_bytes) 
+                         + ", budget evictions " + intToString(snapshot.history_evictions) + "\r\n");
+    server->sendResponse(client, prefix + "flood control delayed clients " 
+                         + intToString(totals.flood_throttles) + " times\r\n");
+    server->sendResponse(client, prefix + "pings sent " + intToString(totals.pings_sent) 
+                         + ", ping timeouts " + intToString(totals.ping_timeouts) 
+                         + ", registration timeouts " + intToString(totals.registration_timeouts) + "\r\n");
+}
+
+// 249 RPL_STATSDEBUG: distribution de la profondeur des SendQ au moment des vidages
+void ServerCommands::sendSendqStats(Server* server, Client* client, const MetricsSnapshot& snapshot) {
+    const Histogram& sendq = snapshot.totals.sendq_bytes;
+    for (size_t i = 0; i < METRICS_BUCKETS; ++i) {
+        if (sendq.buckets[i] > 0) {
+            server->sendResponse(client, "249 " + client->getNickname() + " :sendq <=" 
+                                 + intToString(Histogram::upperBound(i)) + " bytes: " 
+                                 + intToString(sendq.buckets[i]) + " flushes\r\n");
+        }
+    }
+    server->sendResponse(client, "249 " + client->getNickname() + " :reads suspended " 
+                         + intToString(snapshot.totals.read_suspensions) + " times, max SendQ evictions " 
+                         + intToString(snapshot.totals.sendq_evictions) + "\r\n");
+}
+
+// 211 RPL_STATSLINKINFO: octets en attente dans la SendQ de chaque client enregistré
+void ServerCommands::sendLinkInfo(Server* server, Client* client) {
+    std::vector<ClientSummary> clients;
+    server->listClients(clients);
+    for (size_t i = 0; i < clients.size(); ++i) {
+        const ClientSummary& link = clients[i];
+        server->sendResponse(client, "211 " + client->getNickname() + " " + link.nickname 
+                             + "[" + link.username + "@" + link.hostname + "] " 
+                             + intToString(link.client->getQueuedBytes()) + "\r\n");
+    }
+}
+
+// 242 RPL_STATSUPTIME
+void ServerCommands::sendUptime(Server* server, Client* client, const MetricsSnapshot& snapshot) {
+    long uptime = snapshot.uptime_s;
+    char formatted[64];
+    std::snprintf(formatted, sizeof(formatted), "%ld days %ld:%02ld:%02ld", 
+                  uptime / 86400, (uptime / 3600) % 24, (uptime / 60) % 60, uptime % 60);
+    server->sendNumeric(client, RPL_STATSUPTIME, formatted);
+}
+
+// Gérer la commande PING (keepalive initié par le client): renvoyer le jeton
+void ServerCommands::handlePing(Server* server, Client* client, const IrcMessage& msg) {
+    LineBuilder reply(Reactor::current()->getArena());
+    reply << "PONG localhost :" << msg.params[0] << "\r\n";
+    server->sendResponse(client, reply.ref());
+}
+
+// Gérer la commande PONG (réponse au PING du serveur)
+// Rien à faire: toute donnée reçue compte comme activité, et le timer de
+// keepalive du client la constate à son échéance.
+void ServerCommands::handlePong(Server* server, Client* client, const IrcMessage& msg) {
+    (void)server;
+    (void)msg;
+    LOG_DEBUG(LOG_CMD, "PONG from " << client->getFd());
+}
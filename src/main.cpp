@@ -1,4 +1,6 @@
 #include "Server.hpp"
+#include "ServerConfig.hpp"
+#include "Logger.hpp"
 #include <iostream>
 #include <exception>
 #include <cstdlib>    // Pour strtol
@@ -11,12 +13,30 @@
 int main(int argc, char **argv) {
     // Vérification des arguments de la ligne de commande
     // argc = nombre d'arguments, argv = tableau des arguments
-    if (argc != 3) {
-        // Si pas exactement 3 arguments (programme + port + password)
-        std::cerr << "Usage: ./ircserv <port> <password>" << std::endl;
+    if (argc < 3) {
+        // Il faut au moins 3 arguments (programme + port + password), puis des options
+        std::cerr << "Usage: ./ircserv <port> <password> [options]" << std::endl
+                  << "  I/O:        [--engine=io_uring|epoll|poll] [--threads=N] [--flush-delay-ms=N]" << std::endl
+                  << "  Queues:     [--recvq=BYTES] [--sendq=BYTES] [--sendq-soft=BYTES]" << std::endl
+                  << "  Flood:      [--flood-burst=N] [--flood-rate=N] [--excess-flood=disconnect|block]" << std::endl
+                  << "  Accept:     [--listen-backlog=N] [--accept-batch=N]" << std::endl
+                  << "  Timeouts:   [--registration-timeout=SECONDS] [--ping-interval=SECONDS] [--ping-timeout=SECONDS]" << std::endl
+                  << "  Limits:     [--max-clients=N] [--max-channels=N]" << std::endl
+                  << "  History:    [--history-lines=N] [--history-bytes=BYTES] [--history-budget=BYTES] [--history-replay=N]" << std::endl
+                  << "  Logs:       [--log-level=debug|info|warn|error|off] [--log-categories=all|server,net,cmd,chan,client]" << std::endl
+                  << "  Operations: [--metrics-port=N] [--oper-password=PW]" << std::endl;
         return 1; // Code d'erreur pour indiquer une utilisation incorrecte
     }
     
+    // === OPTIONS DE DÉMARRAGE ===
+    ServerConfig config;
+    for (int i = PASSWORD_ARG_INDEX + 1; i < argc; ++i) {
+        if (!config.parseOption(argv[i])) {
+            std::cerr << "Error: Invalid option: " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+    
     try {
         // === CONVERSION ROBUSTE DU PORT ===
         // Utilisation de strtol pour une conversion sécurisée
@@ -54,22 +74,32 @@ int main(int argc, char **argv) {
         std::cout << "Port: " << server_port << std::endl;
         std::cout << "Password: " << password << std::endl;
         
+        // Journal asynchrone (thread d'écriture) jusqu'à la fin du serveur
+        if (config.log_level < LOG_MIN_LEVEL) {
+            std::cerr << "Warning: log levels below " << LOG_MIN_LEVEL 
+                      << " are compiled out (make re LOG_MIN_LEVEL=" << config.log_level << ")" << std::endl;
+        }
+        Logger::start(config.log_level, config.log_categories);
+        
         // Créer l'instance du serveur IRC avec les paramètres
-        Server ircServer(server_port, password);
+        Server ircServer(server_port, password, config);
         
         // Démarrer le serveur (boucle infinie jusqu'à interruption)
         ircServer.start();
         
     } catch (const std::exception& e) {
         // Capturer toutes les exceptions pour éviter les crashes
+        Logger::stop();
         std::cerr << "Server error: " << e.what() << std::endl;
         return 1;
     } catch (...) {
         // Capturer toute autre exception non standard
+        Logger::stop();
         std::cerr << "Unknown server error occurred" << std::endl;
         return 1;
     }
     
+    Logger::stop();
     std::cout << "Server shutdown complete" << std::endl;
     return 0; // Succès
 }
@@ -0,0 +1,577 @@
+// ircbench: générateur de charge pour ircserv
+// Ouvre N connexions, les enregistre (PASS/NICK/USER), les répartit dans M channels,
+// puis envoie un mélange PRIVMSG/JOIN/KICK/MODE à débit fixe. Chaque PRIVMSG porte
+// son horodatage d'envoi: la latence de livraison est mesurée à la réception.
+// Résultats en JSON sur stdout, progression sur stderr.
+// Le contrôle de flood du serveur retarderait la charge: lancer ircserv avec --flood-rate=0
+// (et --history-replay=0: les messages rejoués au JOIN fausseraient les latences).
+// Sinon le rapport l'indique ("throttled"), y compris quand le serveur coupe une connexion.
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+
+#define LATENCY_BUCKETS 1000000             // Histogramme à 1 µs près jusqu'à 1 s
+#define MAX_ACTIONS_PER_TICK 2000           // Rattrapage maximal si la boucle prend du retard
+
+enum ActionType { ACTION_PRIVMSG, ACTION_JOIN, ACTION_KICK, ACTION_MODE, ACTION_COUNT };
+
+static const char* const ACTION_NAMES[ACTION_COUNT] = { "privmsg", "join", "kick", "mode" };
+
+// Options de la ligne de commande (--clé=valeur)
+struct BenchOptions {
+    std::string host;
+    int port;
+    std::string password;
+    int clients;                            // Nombre de connexions
+    int channels;                           // Nombre de channels (membres répartis en tourniquet)
+    int duration_s;                         // Durée de la mesure
+    int rate;                               // Actions par seconde (toutes connexions confondues)
+    int payload;                            // Octets de texte ajoutés à chaque PRIVMSG
+    int weights[ACTION_COUNT];              // Mélange des actions
+
+    BenchOptions() : host("127.0.0.1"), port(6667), password("pw"), clients(50), channels(5),
+                     duration_s(10), rate(5000), payload(32) {
+        weights[ACTION_PRIVMSG] = 100;
+        weights[ACTION_JOIN] = 0;
+        weights[ACTION_KICK] = 0;
+        weights[ACTION_MODE] = 0;
+    }
+};
+
+// Une connexion simulée
+struct Connection {
+    int fd;
+    std::string nick;
+    int channel;                            // Channel principal (index)
+    bool welcomed;                          // 001 reçu
+    bool joined;                            // Présent dans son channel (JOIN confirmé)
+    bool mode_on;                           // Prochain MODE: +t ou -t
+    std::string in;                         // Données reçues, lignes partielles
+    std::string out;                        // Données à envoyer (socket plein)
+};
+
+// Compteurs et histogramme de la mesure
+struct BenchStats {
+    unsigned long sent[ACTION_COUNT];
+    unsigned long expected_deliveries;      // PRIVMSG x (membres - 1) au moment de l'envoi
+    unsigned long delivered;                // PRIVMSG horodatés reçus
+    unsigned long error_replies;            // Numériques 4xx/5xx reçus
+    unsigned long flood_kills;              // "ERROR :Closing Link: Excess Flood" reçus
+    unsigned long bytes_out;
+    unsigned long bytes_in;
+    std::vector<unsigned> latency_us;       // Histogramme (index = µs)
+    unsigned long latency_overflow;         // Au-delà de LATENCY_BUCKETS
+    unsigned long latency_max_us;
+    bool measuring;                         // Ignorer ce qui précède la mesure
+
+    BenchStats() : expected_deliveries(0), delivered(0), error_replies(0), flood_kills(0), bytes_out(0), bytes_in(0),
+                   latency_us(LATENCY_BUCKETS, 0), latency_overflow(0), latency_max_us(0), measuring(false) {
+        for (int i = 0; i < ACTION_COUNT; ++i) {
+            sent[i] = 0;
+        }
+    }
+};
+
+static long long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static std::string toString(long long value) {
+    std::ostringstream oss;
+    oss << value;
+    return oss.str();
+}
+
+static bool parseInt(const std::string& value, int min_value, int max_value, int& out) {
+    char* endptr;
+    long parsed = std::strtol(value.c_str(), &endptr, 10);
+    if (value.empty() || *endptr != '\0' || parsed < min_value || parsed > max_value) {
+        return false;
+    }
+    out = static_cast<int>(parsed);
+    return true;
+}
+
+// "privmsg:90,join:4,kick:3,mode:3"
+static bool parseMix(const std::string& value, int weights[ACTION_COUNT]) {
+    int parsed[ACTION_COUNT] = { 0, 0, 0, 0 };
+    std::stringstream ss(value);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            return false;
+        }
+        std::string name = item.substr(0, colon);
+        int type = 0;
+        while (type < ACTION_COUNT && name != ACTION_NAMES[type]) {
+            ++type;
+        }
+        if (type == ACTION_COUNT || !parseInt(item.substr(colon + 1), 0, 1000000, parsed[type])) {
+            return false;
+        }
+    }
+    int total = 0;
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        total += parsed[i];
+    }
+    if (total == 0) {
+        return false;
+    }
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        weights[i] = parsed[i];
+    }
+    return true;
+}
+
+static bool parseOption(const std::string& option, BenchOptions& opts) {
+    size_t eq_pos = option.find('=');
+    if (option.compare(0, 2, "--") != 0 || eq_pos == std::string::npos) {
+        return false;
+    }
+    std::string key = option.substr(2, eq_pos - 2);
+    std::string value = option.substr(eq_pos + 1);
+
+    if (key == "host") { opts.host = value; return true; }
+    if (key == "password") { opts.password = value; return !value.empty(); }
+    if (key == "port") { return parseInt(value, 1, 65535, opts.port); }
+    if (key == "clients") { return parseInt(value, 2, 100000, opts.clients); }
+    if (key == "channels") { return parseInt(value, 1, 10000, opts.channels); }
+    if (key == "duration") { return parseInt(value, 1, 3600, opts.duration_s); }
+    if (key == "rate") { return parseInt(value, 1, 10000000, opts.rate); }
+    if (key == "payload") { return parseInt(value, 0, 400, opts.payload); }
+    if (key == "mix") { return parseMix(value, opts.weights); }
+    return false;
+}
+
+// Mettre en file puis écrire autant que possible
+static void sendLine(Connection& conn, const std::string& line, BenchStats& stats) {
+    conn.out += line;
+    while (!conn.out.empty()) {
+        ssize_t written = send(conn.fd, conn.out.data(), conn.out.size(), MSG_NOSIGNAL);
+        if (written <= 0) {
+            break; // EAGAIN: le reste partira sur POLLOUT
+        }
+        stats.bytes_out += written;
+        conn.out.erase(0, written);
+    }
+}
+
+static std::string channelName(int index) {
+    return "#bench" + toString(index);
+}
+
+// Traiter une ligne reçue par une connexion
+static void handleLine(std::vector<Connection>& conns, size_t index, const std::string& line,
+                       BenchStats& stats, long long now) {
+    Connection& conn = conns[index];
+
+    // Réponses numériques sans préfixe ("001 nick ..."), ou avec préfixe
+    size_t cmd_start = (line[0] == ':') ? line.find(' ') + 1 : 0;
+    if (cmd_start == 0 && line[0] == ':') {
+        return;
+    }
+    std::string command = line.substr(cmd_start, line.find(' ', cmd_start) - cmd_start);
+
+    if (command == "001") {
+        conn.welcomed = true;
+        return;
+    }
+    if (command == "PING") {
+        // Keepalive du serveur (clients qui ne font que recevoir)
+        sendLine(conn, "PONG" + line.substr(cmd_start + 4) + "\r\n", stats);
+        return;
+    }
+    if (command.size() == 3 && (command[0] == '4' || command[0] == '5')) {
+        ++stats.error_replies;
+        return;
+    }
+    if (command == "ERROR") {
+        if (line.find("Excess Flood", cmd_start) != std::string::npos) {
+            ++stats.flood_kills;
+        }
+        return;
+    }
+    if (command == "PRIVMSG") {
+        size_t marker = line.find(":ircbench ", cmd_start);
+        if (marker == std::string::npos || !stats.measuring) {
+            return;
+        }
+        long long sent_ns = std::strtoll(line.c_str() + marker + 10, NULL, 10);
+        if (sent_ns <= 0) {
+            return;
+        }
+        unsigned long latency = static_cast<unsigned long>((now - sent_ns) / 1000);
+        ++stats.delivered;
+        if (latency < LATENCY_BUCKETS) {
+            ++stats.latency_us[latency];
+        } else {
+            ++stats.latency_overflow;
+        }
+        if (latency > stats.latency_max_us) {
+            stats.latency_max_us = latency;
+        }
+        return;
+    }
+    // Source ":nick!user@host" (ou ":nick" seul)
+    char after_nick = line.size() > conn.nick.size() + 1 ? line[conn.nick.size() + 1] : '\0';
+    if (command == "JOIN" && line.compare(1, conn.nick.size(), conn.nick) == 0 && (after_nick == ' ' || after_nick == '!')) {
+        std::string target = channelName(conn.channel);
+        if (line.find(" JOIN " + target) != std::string::npos) {
+            conn.joined = true;
+        }
+        return;
+    }
+    if (command == "KICK") {
+        // ":op KICK #chan victim :reason" -> la victime revient aussitôt
+        std::string suffix = " " + conn.nick + " :";
+        if (line.find(suffix) != std::string::npos) {
+            conn.joined = false;
+            sendLine(conn, "JOIN " + channelName(conn.channel) + "\r\n", stats);
+        }
+    }
+}
+
+// Lire tout ce qui est disponible et découper en lignes
+static bool readConnection(std::vector<Connection>& conns, size_t index, BenchStats& stats) {
+    Connection& conn = conns[index];
+    char buffer[65536];
+    while (true) {
+        ssize_t received = recv(conn.fd, buffer, sizeof(buffer), 0);
+        if (received == 0) {
+            return false;
+        }
+        if (received < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        stats.bytes_in += received;
+        conn.in.append(buffer, received);
+
+        long long now = nowNs();
+        size_t start = 0;
+        size_t end;
+        while ((end = conn.in.find('\n', start)) != std::string::npos) {
+            size_t length = end - start;
+            if (length > 0 && conn.in[end - 1] == '\r') {
+                --length;
+            }
+            if (length > 0) {
+                handleLine(conns, index, conn.in.substr(start, length), stats, now);
+            }
+            start = end + 1;
+        }
+        conn.in.erase(0, start);
+    }
+}
+
+// Une itération: poll, lectures, écritures en attente
+static bool pumpIo(std::vector<Connection>& conns, std::vector<struct pollfd>& pfds,
+                   BenchStats& stats, int timeout_ms) {
+    for (size_t i = 0; i < conns.size(); ++i) {
+        pfds[i].events = POLLIN | (conns[i].out.empty() ? 0 : POLLOUT);
+        pfds[i].revents = 0;
+    }
+    if (poll(&pfds[0], pfds.size(), timeout_ms) < 0 && errno != EINTR) {
+        std::cerr << "poll failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    for (size_t i = 0; i < conns.size(); ++i) {
+        if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (!readConnection(conns, i, stats)) {
+                std::cerr << "Connection " << conns[i].nick << " closed by server" << std::endl;
+                return false;
+            }
+        }
+        if ((pfds[i].revents & POLLOUT) && !conns[i].out.empty()) {
+            sendLine(conns[i], "", stats);
+        }
+    }
+    return true;
+}
+
+// Attendre qu'une condition soit vraie pour toutes les connexions
+static bool waitAll(std::vector<Connection>& conns, std::vector<struct pollfd>& pfds, BenchStats& stats,
+                    bool Connection::*flag, size_t count, const char* what) {
+    long long deadline = nowNs() + 10000000000LL;
+    while (nowNs() < deadline) {
+        size_t ready = 0;
+        for (size_t i = 0; i < count; ++i) {
+            ready += conns[i].*flag ? 1 : 0;
+        }
+        if (ready == count) {
+            return true;
+        }
+        if (!pumpIo(conns, pfds, stats, 50)) {
+            return false;
+        }
+    }
+    std::cerr << "Timeout while waiting for " << what << std::endl;
+    return false;
+}
+
+static int connectTo(const BenchOptions& opts) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(opts.port);
+    if (inet_pton(AF_INET, opts.host.c_str(), &addr.sin_addr) != 1 ||
+        connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    return fd;
+}
+
+// Choisir une action selon le mélange demandé
+static int pickAction(const BenchOptions& opts, int total_weight) {
+    int roll = std::rand() % total_weight;
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        if (roll < opts.weights[i]) {
+            return i;
+        }
+        roll -= opts.weights[i];
+    }
+    return ACTION_PRIVMSG;
+}
+
+// Exécuter une action au nom de la connexion choisie
+static void performAction(std::vector<Connection>& conns, const std::vector<std::vector<size_t> >& members,
+                          size_t index, int action, BenchStats& stats,
+                          unsigned long seq, const std::string& padding) {
+    Connection& conn = conns[index];
+    const std::vector<size_t>& channel_members = members[conn.channel];
+    std::string channel = channelName(conn.channel);
+
+    // KICK et MODE exigent l'opérateur du channel: c'est lui qui agit
+    if (action == ACTION_KICK || action == ACTION_MODE) {
+        Connection& op = conns[channel_members[0]];
+        if (action == ACTION_MODE) {
+            sendLine(op, "MODE " + channel + (op.mode_on ? " +t" : " -t") + "\r\n", stats);
+            op.mode_on = !op.mode_on;
+        } else {
+            size_t victim = channel_members[1 + std::rand() % (channel_members.size() - 1)];
+            if (!conns[victim].joined) {
+                action = ACTION_PRIVMSG; // Déjà éjectée, pas encore revenue
+            } else {
+                sendLine(op, "KICK " + channel + " " + conns[victim].nick + " :ircbench\r\n", stats);
+            }
+        }
+    }
+    if (action == ACTION_JOIN) {
+        std::string extra = "#benchx" + toString(index);
+        sendLine(conn, "JOIN " + extra + "\r\nPART " + extra + "\r\n", stats);
+    }
+    if (action == ACTION_PRIVMSG) {
+        if (!conn.joined) {
+            return;
+        }
+        size_t present = 0;
+        for (size_t i = 0; i < channel_members.size(); ++i) {
+            present += conns[channel_members[i]].joined ? 1 : 0;
+        }
+        stats.expected_deliveries += present - 1;
+        sendLine(conn, "PRIVMSG " + channel + " :ircbench " + toString(nowNs()) + " " +
+                 toString(seq) + " " + padding + "\r\n", stats);
+    }
+    if (stats.measuring) {
+        ++stats.sent[action];
+    }
+}
+
+// Latence au rang demandé; LATENCY_BUCKETS si ce rang tombe au-delà de l'histogramme
+static unsigned long percentile(const BenchStats& stats, double fraction) {
+    unsigned long total = stats.delivered;
+    if (total == 0) {
+        return 0;
+    }
+    unsigned long rank = static_cast<unsigned long>(fraction * total);
+    if (rank >= total) {
+        rank = total - 1;
+    }
+    unsigned long seen = 0;
+    for (size_t i = 0; i < stats.latency_us.size(); ++i) {
+        seen += stats.latency_us[i];
+        if (seen > rank) {
+            return i;
+        }
+    }
+    return LATENCY_BUCKETS;
+}
+
+// Valeur JSON d'un percentile: nombre, ou ">=LATENCY_BUCKETS" s'il déborde de l'histogramme
+static std::string formatPercentile(const BenchStats& stats, double fraction) {
+    unsigned long value = percentile(stats, fraction);
+    if (value >= LATENCY_BUCKETS) {
+        return "\">=" + toString(LATENCY_BUCKETS) + "\"";
+    }
+    return toString(value);
+}
+
+static void printReport(const BenchOptions& opts, const BenchStats& stats, double elapsed_s) {
+    unsigned long total_sent = 0;
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        total_sent += stats.sent[i];
+    }
+    // Connexion coupée pour flood, ou livraisons encore manquantes après le drain
+    // (contrôle de flood du serveur, ou saturation)
+    bool throttled = stats.flood_kills > 0 || stats.delivered < stats.expected_deliveries;
+    std::ostringstream json;
+    json.setf(std::ios::fixed);
+    json.precision(1);
+    json << "{\n"
+         << "  \"clients\": " << opts.clients << ",\n"
+         << "  \"channels\": " << opts.channels << ",\n"
+         << "  \"rate\": " << opts.rate << ",\n"
+         << "  \"payload\": " << opts.payload << ",\n"
+         << "  \"duration_s\": " << elapsed_s << ",\n"
+         << "  \"sent\": {";
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        json << (i ? ", " : " ") << "\"" << ACTION_NAMES[i] << "\": " << stats.sent[i];
+    }
+    json << " },\n"
+         << "  \"commands_per_sec\": " << total_sent / elapsed_s << ",\n"
+         << "  \"expected_deliveries\": " << stats.expected_deliveries << ",\n"
+         << "  \"delivered\": " << stats.delivered << ",\n"
+         << "  \"throttled\": " << (throttled ? "true" : "false") << ",\n"
+         << "  \"flood_kills\": " << stats.flood_kills << ",\n"
+         << "  \"messages_per_sec\": " << stats.delivered / elapsed_s << ",\n"
+         << "  \"bytes_out_per_sec\": " << stats.bytes_out / elapsed_s << ",\n"
+         << "  \"bytes_in_per_sec\": " << stats.bytes_in / elapsed_s << ",\n"
+         << "  \"error_replies\": " << stats.error_replies << ",\n"
+         << "  \"latency_us\": { \"p50\": " << formatPercentile(stats, 0.50)
+         << ", \"p99\": " << formatPercentile(stats, 0.99)
+         << ", \"p999\": " << formatPercentile(stats, 0.999)
+         << ", \"max\": " << stats.latency_max_us << " },\n"
+         << "  \"latency_overflow\": " << stats.latency_overflow << "\n"
+         << "}\n";
+    std::cout << json.str();
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        if (!parseOption(argv[i], opts)) {
+            std::cerr << "Usage: ./ircbench [--host=IP] [--port=N] [--password=PW] [--clients=N] [--channels=M]\n"
+                      << "                  [--duration=S] [--rate=ACTIONS/S] [--payload=BYTES]\n"
+                      << "                  [--mix=privmsg:90,join:4,kick:3,mode:3]\n"
+                      << "Run ircserv with --flood-rate=0 --history-replay=0: flood control would delay the load\n"
+                      << "(reported as \"throttled\") and replayed history would skew latencies." << std::endl;
+            return 1;
+        }
+    }
+    if (opts.channels * 2 > opts.clients) {
+        std::cerr << "Error: need at least two clients per channel" << std::endl;
+        return 1;
+    }
+    signal(SIGPIPE, SIG_IGN);
+    std::srand(static_cast<unsigned>(nowNs()));
+
+    BenchStats stats;
+    std::vector<Connection> conns(opts.clients);
+    std::vector<struct pollfd> pfds(opts.clients);
+    std::vector<std::vector<size_t> > members(opts.channels);
+
+    // === CONNEXION ET ENREGISTREMENT ===
+    std::cerr << "Connecting " << opts.clients << " clients to " << opts.host << ":" << opts.port << "..." << std::endl;
+    for (int i = 0; i < opts.clients; ++i) {
+        Connection& conn = conns[i];
+        conn.fd = connectTo(opts);
+        if (conn.fd < 0) {
+            std::cerr << "Failed to connect client " << i << ": " << strerror(errno) << std::endl;
+            return 1;
+        }
+        conn.nick = "bench" + toString(i);
+        conn.channel = i % opts.channels;
+        conn.welcomed = conn.joined = conn.mode_on = false;
+        members[conn.channel].push_back(i);
+        pfds[i].fd = conn.fd;
+        sendLine(conn, "PASS " + opts.password + "\r\nNICK " + conn.nick + "\r\nUSER " + conn.nick +
+                 " 0 * :ircbench\r\n", stats);
+    }
+    if (!waitAll(conns, pfds, stats, &Connection::welcomed, conns.size(), "registration")) {
+        return 1;
+    }
+
+    // Les opérateurs d'abord (premier membre = opérateur), puis les autres
+    for (int i = 0; i < opts.clients; ++i) {
+        if (i == opts.channels && !waitAll(conns, pfds, stats, &Connection::joined, opts.channels, "operators")) {
+            return 1;
+        }
+        sendLine(conns[i], "JOIN " + channelName(conns[i].channel) + "\r\n", stats);
+    }
+    if (!waitAll(conns, pfds, stats, &Connection::joined, conns.size(), "channel joins")) {
+        return 1;
+    }
+
+    // === MESURE ===
+    std::cerr << "Running for " << opts.duration_s << "s at " << opts.rate << " actions/s..." << std::endl;
+    int total_weight = 0;
+    for (int i = 0; i < ACTION_COUNT; ++i) {
+        total_weight += opts.weights[i];
+    }
+    std::string padding(opts.payload, 'x');
+    long long interval_ns = 1000000000LL / opts.rate;
+    long long start = nowNs();
+    long long end = start + opts.duration_s * 1000000000LL;
+    long long next_action = start;
+    unsigned long seq = 0;
+    size_t next_client = 0;
+    stats.measuring = true;
+    bool closed = false;
+
+    while (!closed && nowNs() < end) {
+        long long now = nowNs();
+        int actions = 0;
+        while (next_action <= now && actions < MAX_ACTIONS_PER_TICK) {
+            performAction(conns, members, next_client, pickAction(opts, total_weight), stats, seq++, padding);
+            next_client = (next_client + 1) % conns.size();
+            next_action += interval_ns;
+            ++actions;
+        }
+        if (next_action < now - 1000000000LL) {
+            next_action = now; // Le serveur ne suit pas: ne pas accumuler de retard infini
+        }
+        long long wait_ns = next_action - nowNs();
+        int timeout_ms = wait_ns > 0 ? static_cast<int>(wait_ns / 1000000) : 0;
+        // Connexion coupée (flood, SendQ): arrêter la mesure mais rendre le rapport
+        closed = !pumpIo(conns, pfds, stats, timeout_ms);
+    }
+    double elapsed_s = (nowNs() - start) / 1e9;
+
+    // Laisser arriver les messages encore en vol
+    long long drain_end = nowNs() + 1000000000LL;
+    while (!closed && nowNs() < drain_end && stats.delivered < stats.expected_deliveries) {
+        if (!pumpIo(conns, pfds, stats, 10)) {
+            break;
+        }
+    }
+
+    printReport(opts, stats, elapsed_s);
+    for (size_t i = 0; i < conns.size(); ++i) {
+        close(conns[i].fd);
+    }
+    return closed ? 1 : 0;
+}
@@ -0,0 +1,321 @@
+// microbench: mesures isolées des chemins chauds du serveur
+// Chaque mesure est répétée jusqu'à couvrir au moins MIN_RUN_NS, puis rapportée
+// en ns/op et allocations/op (operator new est instrumenté dans ce binaire).
+// Les clients n'ont pas de socket: les envois s'arrêtent dans leur SendQueue.
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <sys/uio.h>
+
+#include "Server.hpp"
+#include "Reactor.hpp"
+#include "Client.hpp"
+#include "Channel.hpp"
+#include "LockGuard.hpp"
+#include "RecvBuffer.hpp"
+#include "IrcMessage.hpp"
+#include "Logger.hpp"
+#include "commands/ChannelCommands.hpp"
+#include "utils.hpp"
+
+#define MIN_RUN_NS 200000000LL              // Durée minimale d'une mesure (200 ms)
+
+// === COMPTAGE DES ALLOCATIONS ===
+static unsigned long g_allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc) {
+    ++g_allocations;
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) throw() {
+    std::free(ptr);
+}
+
+static long long nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Accès aux membres privés du serveur (déclaré ami dans Server.hpp)
+struct ServerBench {
+    static void parseCommand(Server& server, Client* client, const StringRef& line) {
+        server._parseCommand(client, line);
+    }
+    // Désinscrire le nickname (comme une déconnexion) avant de libérer le client
+    static void destroyClient(Server& server, Client* client) {
+        server._detachClient(client, "Benchmark done");
+        delete client;
+    }
+    // Quitter un channel sans prévenir ses membres (pas de QUIT en O(n²) au démontage)
+    static void leaveChannel(Server& server, Channel* channel, Client* client) {
+        LockGuard guard(channel->getLock());
+        server.removeFromChannel(channel, client);
+    }
+};
+
+// Une mesure: run() est appelé en boucle, reset() hors chronomètre entre les lots
+class Benchmark {
+public:
+    virtual ~Benchmark() {}
+    virtual const char* name() const = 0;
+    virtual void run(long iteration) = 0;
+    virtual void reset() {}
+};
+
+// Chronométrer par lots de taille croissante jusqu'à MIN_RUN_NS
+static void measure(Benchmark& bench) {
+    TickArena& arena = Reactor::current()->getArena();
+    long batch = 1;
+    long long elapsed = 0;
+    long total = 0;
+    unsigned long allocations = 0;
+    while (elapsed < MIN_RUN_NS) {
+        bench.reset();
+        unsigned long allocs_before = g_allocations;
+        long long start = nowNs();
+        for (long i = 0; i < batch; ++i) {
+            bench.run(total + i);
+            arena.reset(); // Une itération de boucle par opération
+        }
+        elapsed += nowNs() - start;
+        allocations += g_allocations - allocs_before;
+        total += batch;
+        if (batch < (1L << 20)) {
+            batch *= 2;
+        }
+    }
+    std::cout << std::left << std::setw(44) << bench.name() << std::right << std::fixed
+              << std::setprecision(1) << std::setw(12) << static_cast<double>(elapsed) / total << " ns/op"
+              << std::setprecision(2) << std::setw(10) << static_cast<double>(allocations) / total << " allocs/op"
+              << std::endl;
+}
+
+// Client sans socket rattaché au reactor de mesure
+static Client* makeClient(Server& server, const std::string& nick, unsigned long id) {
+    Client* client = new Client(-1, "127.0.0.1", 512);
+    client->setOwner(server.getReactor(0), id);
+    client->setPasswordOk(true);
+    server.changeNickname(client, nick);
+    client->setUsername(nick);
+    return client;
+}
+
+// === DISPATCH DES COMMANDES ===
+class ParseCommandBench : public Benchmark {
+private:
+    Server& _server;
+    Client* _client;
+public:
+    ParseCommandBench(Server& server, Client* client) : _server(server), _client(client) {}
+    const char* name() const { return "Server::_parseCommand (unknown cmd)"; }
+    void run(long) {
+        // Chemin complet: parse, table, vérifications, réponse 421 en file
+        ServerBench::parseCommand(_server, _client, StringRef("FOO #chan :hello world"));
+    }
+    void reset() { _client->getSendQueue().clear(); }
+};
+
+class ParsePrivmsgBench : public Benchmark {
+private:
+    Server& _server;
+    Client* _client;
+public:
+    ParsePrivmsgBench(Server& server, Client* client) : _server(server), _client(client) {}
+    const char* name() const { return "Server::_parseCommand (PRIVMSG nick)"; }
+    void run(long) {
+        ServerBench::parseCommand(_server, _client, StringRef("PRIVMSG bench1 :hello world"));
+    }
+    void reset() {
+        _client->getSendQueue().clear();
+        _server.findClientByNickname("bench1")->getSendQueue().clear();
+    }
+};
+
+// === DÉCOUPAGE DES LIGNES ===
+class FramingBench : public Benchmark {
+private:
+    RecvBuffer _buffer;
+    std::string _input;                     // 16 commandes pipelinées
+    size_t _lines;
+public:
+    FramingBench() : _buffer(8192), _lines(0) {
+        for (int i = 0; i < 16; ++i) {
+            _input += "PRIVMSG #channel :message number " + intToString(i) + "\r\n";
+        }
+    }
+    const char* name() const { return "RecvBuffer framing (16 lines/op)"; }
+    void run(long) {
+        // Copier comme le ferait readv(), puis extraire toutes les lignes
+        struct iovec iov[2];
+        int regions = _buffer.writableRegions(iov);
+        size_t copied = 0;
+        for (int r = 0; r < regions && copied < _input.size(); ++r) {
+            size_t chunk = std::min(iov[r].iov_len, _input.size() - copied);
+            std::memcpy(iov[r].iov_base, _input.data() + copied, chunk);
+            copied += chunk;
+        }
+        _buffer.commit(copied);
+        StringRef line;
+        while (_buffer.nextLine(line) != RecvBuffer::LINE_NONE) {
+            _lines += line.length;
+        }
+    }
+};
+
+// === DIFFUSION DANS UN CHANNEL ===
+class BroadcastBench : public Benchmark {
+private:
+    Server& _server;
+    Channel* _channel;
+    std::vector<Client*> _members;
+    std::string _name;
+public:
+    BroadcastBench(Server& server, size_t members, unsigned long& next_id)
+        : _server(server), _name("Channel fan-out (" + intToString(members) + " members)") {
+        _channel = server.lockChannel("#bcast" + intToString(members), true);
+        LockGuard guard(_channel->getLock(), LOCK_ADOPT);
+        for (size_t i = 0; i < members; ++i) {
+            Client* client = makeClient(server, "bc" + intToString(members) + "_" + intToString(i), next_id++);
+            _channel->addMember(client, i == 0);
+            _members.push_back(client);
+        }
+    }
+    ~BroadcastBench() {
+        for (size_t i = 0; i < _members.size(); ++i) {
+            ServerBench::leaveChannel(_server, _channel, _members[i]);
+            ServerBench::destroyClient(_server, _members[i]);
+        }
+    }
+    const char* name() const { return _name.c_str(); }
+    // Comme PRIVMSG: destinataires relevés sous le verrou du channel, envois après
+    void run(long) {
+        std::vector<Client*>& recipients = Reactor::current()->getRecipients();
+        {
+            LockGuard guard(_channel->getLock());
+            _channel->collectMembers(recipients, _members[0]);
+        }
+        _server.deliver(recipients, ":bc_0 PRIVMSG #bcast :hello everyone\r\n");
+    }
+    void reset() {
+        for (size_t i = 0; i < _members.size(); ++i) {
+            _members[i]->getSendQueue().clear();
+        }
+    }
+};
+
+// === RECHERCHE PAR NICKNAME ===
+class NicknameLookupBench : public Benchmark {
+private:
+    Server& _server;
+    std::vector<Client*> _clients;
+    std::vector<std::string> _queries;      // Casse différente de l'enregistrement
+public:
+    NicknameLookupBench(Server& server, size_t count, unsigned long& next_id) : _server(server) {
+        for (size_t i = 0; i < count; ++i) {
+            std::string nick = "user" + intToString(i);
+            _clients.push_back(makeClient(server, nick, next_id++));
+            if (i % 97 == 0) {
+                _queries.push_back("USER" + intToString(i));
+            }
+        }
+    }
+    ~NicknameLookupBench() {
+        for (size_t i = 0; i < _clients.size(); ++i) {
+            ServerBench::destroyClient(_server, _clients[i]);
+        }
+    }
+    const char* name() const { return "findClientByNickname (100k users)"; }
+    void run(long iteration) {
+        const std::string& query = _queries[iteration % _queries.size()];
+        if (_server.findClientByNickname(query) == NULL) {
+            std::abort();
+        }
+    }
+};
+
+// === PARSING DE MODE ===
+class ModeBench : public Benchmark {
+private:
+    Server& _server;
+    Client* _client;
+    IrcMessage _set;
+    IrcMessage _unset;
+    std::string _set_line;
+    std::string _unset_line;
+public:
+    ModeBench(Server& server, Client* client)
+        : _server(server), _client(client), _set_line("MODE #modes +itkl secret 50"), _unset_line("MODE #modes -itkl") {
+        IrcMessage::parse(StringRef(_set_line), _set);
+        IrcMessage::parse(StringRef(_unset_line), _unset);
+        Channel* channel = server.lockChannel("#modes", true);
+        LockGuard guard(channel->getLock(), LOCK_ADOPT);
+        channel->addMember(client, true);
+    }
+    const char* name() const { return "ChannelCommands::handleMode (4 modes)"; }
+    void run(long iteration) {
+        ChannelCommands::handleMode(&_server, _client, (iteration & 1) ? _unset : _set);
+    }
+    void reset() { _client->getSendQueue().clear(); }
+};
+
+int main() {
+    Logger::start(LOG_LEVEL_WARN, LOG_ALL);
+    {
+        ServerConfig config;
+        config.sendq_bytes = 1 << 30;                  // Les files ne sont vidées qu'entre les lots
+        Server server(0, "pw", config);                // Port 0: aucun client réel
+        Reactor::setCurrent(server.getReactor(0));     // Les envois restent dans ce shard
+        unsigned long next_id = 1;
+
+        Client* sender = makeClient(server, "bench0", next_id++);
+        Client* target = makeClient(server, "bench1", next_id++);
+
+        std::cout << std::left << std::setw(44) << "Benchmark" << "        time           allocations" << std::endl;
+        {
+            ParseCommandBench bench(server, sender);
+            measure(bench);
+        }
+        {
+            ParsePrivmsgBench bench(server, sender);
+            measure(bench);
+            target->getSendQueue().clear();
+        }
+        {
+            FramingBench bench;
+            measure(bench);
+        }
+        const size_t sizes[] = { 10, 1000, 10000 };
+        for (size_t i = 0; i < 3; ++i) {
+            BroadcastBench bench(server, sizes[i], next_id);
+            measure(bench);
+        }
+        {
+            NicknameLookupBench bench(server, 100000, next_id);
+            measure(bench);
+        }
+        {
+            ModeBench bench(server, sender);
+            measure(bench);
+        }
+
+        ServerBench::leaveChannel(server, server.findChannel("#modes"), sender);
+        ServerBench::destroyClient(server, sender);
+        ServerBench::destroyClient(server, target);
+        Reactor::setCurrent(NULL);
+    }
+    Logger::stop();
+    return 0;
+}